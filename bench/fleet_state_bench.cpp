@@ -0,0 +1,94 @@
+// Approximate floors of a whole fleet, as dispatch needs them on every tick:
+// Elevator::elevator_aproximate_floor per elevator, against the FleetState
+// kernels. tests/fleet_state_test checks that they all agree.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "elevator.h"
+#include "fleet_state.h"
+
+namespace {
+
+size_t const floors = 500;
+size_t const times = 2000;
+
+std::vector<Elevator> random_fleet(size_t elevators, std::mt19937_64 &random) {
+  double const loads[] = {90, 130, 260, 500};
+  std::vector<Elevator> fleet;
+  fleet.reserve(elevators);
+  for (size_t i = 0; i < elevators; ++i) {
+    Elevator &elevator = fleet.emplace_back(
+        i + 1, static_cast<int>(1 + random() % floors), loads[random() % 4],
+        floors);
+    size_t const started = random() % 20000;
+    elevator.set_target_floor(1 + random() % floors);
+    elevator.set_state(static_cast<ElevatorState>(random() % 4), started);
+    elevator.calculate_moving_time(started);
+  }
+  return fleet;
+}
+
+template <typename Body>
+double seconds(Body &&body) {
+  auto const start = std::chrono::steady_clock::now();
+  body();
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+void run(size_t elevators) {
+  std::mt19937_64 random(elevators);
+  std::vector<Elevator> const fleet = random_fleet(elevators, random);
+  FleetState scalar(fleet, FleetState::Kernel::Scalar);
+  FleetState packed(fleet);
+
+  std::vector<size_t> clock(times);
+  for (auto &time : clock) {
+    time = random() % 40000;
+  }
+
+  int checksum = 0;
+  double const per_elevator = seconds([&] {
+    for (size_t time : clock) {
+      for (auto const &elevator : fleet) {
+        checksum +=
+            static_cast<int>(elevator.elevator_aproximate_floor(time + 1));
+      }
+    }
+  });
+  double const per_scalar = seconds([&] {
+    for (size_t time : clock) {
+      checksum += scalar.approximate_floors(time + 1)[0];
+    }
+  });
+  double const per_packed = seconds([&] {
+    for (size_t time : clock) {
+      checksum += packed.approximate_floors(time + 1)[0];
+    }
+  });
+
+  double const scale = 1e9 / static_cast<double>(times * elevators);
+  std::cout << elevators << " elevators: Elevator " << per_elevator * scale
+            << " ns, scalar kernel " << per_scalar * scale
+            << " ns, best kernel " << per_packed * scale
+            << " ns per elevator (checksum " << checksum << ")" << std::endl;
+}
+
+}  // namespace
+
+int main() {
+  std::cout << "best kernel: "
+            << (FleetState::best_kernel() == FleetState::Kernel::Avx2
+                    ? "AVX2"
+                    : "scalar")
+            << std::endl;
+
+  for (size_t elevators : {5, 64, 1000, 10000}) {
+    run(elevators);
+  }
+  return 0;
+}
@@ -0,0 +1,81 @@
+// Cost of finding the floors that need an elevator once per tick: the scan
+// over every floor's waiting list with a std::set of called floors that
+// ElevatorSystem::process_tick did before, against walking a FloorBitset of
+// unassigned hall calls.
+
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "floor_bitset.h"
+
+namespace {
+
+size_t const ticks = 200000;
+
+template <typename Scan>
+void report(char const *name, size_t floors, Scan &&scan) {
+  auto const start = std::chrono::steady_clock::now();
+  size_t checksum = 0;
+  for (size_t tick = 0; tick < ticks; ++tick) {
+    checksum += scan();
+  }
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::cout << floors << " floors, " << name << ": "
+            << elapsed.count() * 1e9 / ticks << " ns/tick (checksum "
+            << checksum << ")" << std::endl;
+}
+
+void run(size_t floors, size_t active_floors) {
+  std::mt19937_64 random(42);
+  int passenger = 0;
+
+  std::vector<std::list<int *>> waiting(floors + 1);
+  std::set<size_t> called;
+  FloorBitset unassigned(floors + 1);
+  for (size_t i = 0; i < active_floors; ++i) {
+    size_t const floor = 1 + random() % floors;
+    waiting[floor].push_back(&passenger);
+    if (i % 2 == 0) {
+      called.insert(floor);
+    }
+  }
+  for (size_t floor = 1; floor <= floors; ++floor) {
+    if (!waiting[floor].empty() && !called.contains(floor)) {
+      unassigned.set(floor);
+    }
+  }
+
+  report("list scan + std::set", floors, [&waiting, &called]() {
+    size_t found = 0;
+    for (size_t floor = 1; floor < waiting.size(); ++floor) {
+      if (!waiting[floor].empty() && !called.contains(floor)) {
+        found += floor;
+      }
+    }
+    return found;
+  });
+
+  report("FloorBitset walk", floors, [&unassigned]() {
+    size_t found = 0;
+    for (size_t floor = unassigned.find_next(1); floor != FloorBitset::npos;
+         floor = unassigned.find_next(floor + 1)) {
+      found += floor;
+    }
+    return found;
+  });
+}
+
+}  // namespace
+
+int main() {
+  run(16, 4);
+  run(120, 8);
+  run(2000, 16);
+  return 0;
+}
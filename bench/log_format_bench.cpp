@@ -0,0 +1,117 @@
+// Records per second of log message formatting: the per-placeholder
+// find/replace implementation client_logger used before, against the
+// precompiled log_format.
+
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "client_logger_builder.h"
+#include "log_format.h"
+#include "logger.h"
+
+namespace {
+
+std::string const format = "[%d %t][%s] %m";
+size_t const records = 2000000;
+
+std::string legacy_format_log(std::string const &log_format,
+                              std::string const &message,
+                              std::string const &severity_str,
+                              time_t current_date_time) {
+  std::string formatted_log = log_format;
+  struct tm *timeinfo = gmtime(&current_date_time);
+
+  size_t pos = 0;
+  while ((pos = formatted_log.find("%d", pos)) != std::string::npos) {
+    char date_str[11];
+    strftime(date_str, sizeof(date_str), "%Y-%m-%d", timeinfo);
+    formatted_log.replace(pos, 2, date_str);
+    pos += strlen(date_str);
+  }
+
+  pos = 0;
+  while ((pos = formatted_log.find("%t", pos)) != std::string::npos) {
+    char time_str[9];
+    strftime(time_str, sizeof(time_str), "%H:%M:%S", timeinfo);
+    formatted_log.replace(pos, 2, time_str);
+    pos += strlen(time_str);
+  }
+
+  pos = 0;
+  while ((pos = formatted_log.find("%s", pos)) != std::string::npos) {
+    formatted_log.replace(pos, 2, severity_str);
+    pos += severity_str.length();
+  }
+
+  pos = 0;
+  while ((pos = formatted_log.find("%m", pos)) != std::string::npos) {
+    formatted_log.replace(pos, 2, message);
+    pos += message.size();
+  }
+
+  return formatted_log;
+}
+
+template <typename Body>
+void report(char const *name, Body &&body) {
+  auto const start = std::chrono::steady_clock::now();
+  size_t const checksum = body();
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::cout << name << ": " << static_cast<size_t>(records / elapsed.count())
+            << " records/s (" << elapsed.count() << " s, checksum "
+            << checksum << ")" << std::endl;
+}
+
+} // namespace
+
+int main() {
+  std::vector<std::string> messages;
+  for (size_t i = 0; i < 64; ++i) {
+    messages.push_back("[" + std::to_string(i * 37) + "] Passenger #" +
+                       std::to_string(i) + " entered elevator on floor " +
+                       std::to_string(i % 20));
+  }
+
+  report("legacy find/replace", [&messages]() {
+    size_t checksum = 0;
+    for (size_t i = 0; i < records; ++i) {
+      checksum += legacy_format_log(format, messages[i % messages.size()],
+                                    "INFORMATION", time(nullptr))
+                      .size();
+    }
+    return checksum;
+  });
+
+  report("compiled log_format", [&messages]() {
+    log_format const compiled(format);
+    std::string buffer;
+    size_t checksum = 0;
+    for (size_t i = 0; i < records; ++i) {
+      compiled.render(buffer, messages[i % messages.size()],
+                      logger::severity::information, time(nullptr));
+      checksum += buffer.size();
+    }
+    return checksum;
+  });
+
+  client_logger_builder builder;
+  builder.set_log_format(format);
+  builder.add_file_stream("/dev/null", logger::severity::information);
+  std::unique_ptr<logger> sink(builder.build());
+
+  report("client_logger::log to /dev/null", [&messages, &sink]() {
+    for (size_t i = 0; i < records; ++i) {
+      sink->information(messages[i % messages.size()]);
+    }
+    return size_t{0};
+  });
+
+  return 0;
+}
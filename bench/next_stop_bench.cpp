@@ -0,0 +1,82 @@
+// Next-stop search over cabin buttons, as calculate_next_elevator_target
+// does on every arrival and interrupt: the floor-by-floor std::vector<bool>
+// walk used before, against FloorBitset::find_next/find_prev, for buildings
+// of 100 to 10,000 floors with a handful of buttons pressed.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "floor_bitset.h"
+
+namespace {
+
+size_t const queries = 1000000;
+size_t const pressed = 4;
+
+template <typename Search>
+void report(char const *name, size_t floors, Search &&search) {
+  std::mt19937_64 random(7);
+  std::vector<size_t> from(queries);
+  for (auto &floor : from) {
+    floor = 1 + random() % floors;
+  }
+
+  auto const start = std::chrono::steady_clock::now();
+  size_t checksum = 0;
+  for (size_t floor : from) {
+    checksum += search(floor);
+  }
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::cout << floors << " floors, " << name << ": "
+            << elapsed.count() * 1e9 / queries << " ns/query (checksum "
+            << checksum << ")" << std::endl;
+}
+
+void run(size_t floors) {
+  std::mt19937_64 random(42);
+  std::vector<bool> buttons(floors + 1, false);
+  FloorBitset bitset(floors + 1);
+  for (size_t i = 0; i < pressed; ++i) {
+    size_t const floor = 1 + random() % floors;
+    buttons.at(floor) = true;
+    bitset.set(floor);
+  }
+
+  // Up first, then down, like a car moving up.
+  report("std::vector<bool> walk", floors, [&buttons](size_t floor) {
+    for (size_t f = floor + 1; f < buttons.size(); ++f) {
+      if (buttons.at(f)) {
+        return f;
+      }
+    }
+    for (size_t f = floor - 1; f != static_cast<size_t>(-1); --f) {
+      if (buttons.at(f)) {
+        return f;
+      }
+    }
+    return size_t{0};
+  });
+
+  report("FloorBitset search", floors, [&bitset](size_t floor) {
+    if (size_t const f = bitset.find_next(floor + 1); f != FloorBitset::npos) {
+      return f;
+    }
+    if (size_t const f = bitset.find_prev(floor - 1); f != FloorBitset::npos) {
+      return f;
+    }
+    return size_t{0};
+  });
+}
+
+}  // namespace
+
+int main() {
+  for (size_t floors : {100, 1000, 10000}) {
+    run(floors);
+  }
+  return 0;
+}
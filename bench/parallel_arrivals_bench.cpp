@@ -0,0 +1,83 @@
+// One synthetic day on a large fleet, simulated with the arrivals of every
+// tick handled on 1 to N threads. Each run has to end at the same time with
+// the same passenger totals as the sequential one, or the bench fails.
+//
+// Usage: parallel_arrivals_bench [max threads]
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dispatch_policy.h"
+#include "elevator_file_parser.h"
+#include "elevator_system.h"
+#include "traffic_generator.h"
+
+namespace {
+
+size_t const floors = 60;
+size_t const elevators = 500;
+double const hourly_rate = 20000;
+size_t const hours = 1;
+
+struct Outcome {
+  PassengerTotals totals;
+  size_t end_time = 0;
+  double seconds = 0;
+};
+
+Outcome run(std::vector<PassengerRecord> const &passengers, size_t threads) {
+  ElevatorSystem<EtaDispatch> system(
+      make_elevators(floors, std::vector<double>(elevators, 500)), floors,
+      nullptr);
+  system.set_threads(threads);
+
+  auto const start = std::chrono::steady_clock::now();
+  system.model(passengers);
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+  return {system.passenger_totals(), system.time(), elapsed.count()};
+}
+
+bool same(Outcome const &a, Outcome const &b) {
+  return a.end_time == b.end_time &&
+         a.totals.delivered == b.totals.delivered &&
+         a.totals.total_wait == b.totals.total_wait &&
+         a.totals.max_wait == b.totals.max_wait &&
+         a.totals.total_travel == b.totals.total_travel &&
+         a.totals.max_travel == b.totals.max_travel;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+  if (argc > 1) {
+    max_threads = std::stoull(argv[1]);
+  }
+
+  TrafficGenerator const traffic(
+      TrafficProfile::uniform(floors, hourly_rate, hours));
+  std::vector<PassengerRecord> const passengers = traffic.generate(17);
+  std::cout << passengers.size() << " passengers, " << elevators
+            << " elevators, " << floors << " floors\n";
+
+  Outcome const sequential = run(passengers, 1);
+  std::cout << "threads 1: " << sequential.seconds << " s, "
+            << sequential.totals.delivered << " delivered by "
+            << sequential.end_time << "\n";
+
+  bool ok = true;
+  for (size_t threads = 2; threads <= max_threads; ++threads) {
+    Outcome const parallel = run(passengers, threads);
+    bool const matches = same(parallel, sequential);
+    ok = ok && matches;
+    std::cout << "threads " << threads << ": " << parallel.seconds
+              << " s, speedup " << sequential.seconds / parallel.seconds
+              << (matches ? "" : "  MISMATCH") << "\n";
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+// Parse throughput for a synthetic passengers file: the ifstream >> and
+// substr/stoull path ElevatorSystem used before, against the mmap-based
+// PassengerFileParser.
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "passenger_file_parser.h"
+
+namespace {
+
+size_t const records = 2000000;
+std::string const path = "passenger_parse_bench.txt";
+
+void write_trace() {
+  std::ofstream out(path);
+  std::mt19937_64 random(42);
+  for (size_t id = 1; id <= records; ++id) {
+    size_t const minutes = (id * 7) % (24 * 60);
+    out << id << ' ' << 40 + (random() % 800) / 10.0 << ' '
+        << 1 + random() % 120 << ' ' << (minutes / 60 < 10 ? "0" : "")
+        << minutes / 60 << ':' << (minutes % 60 < 10 ? "0" : "")
+        << minutes % 60 << ' ' << 1 + random() % 120 << '\n';
+  }
+}
+
+size_t legacy_time_to_numerical(std::string const &time) {
+  size_t colon_pos = time.find(':');
+  std::string hours_str = time.substr(0, colon_pos);
+  std::string minutes_str = time.substr(colon_pos + 1);
+  return (std::stoull(hours_str) * 60) + std::stoull(minutes_str);
+}
+
+template <typename Body>
+void report(char const *name, size_t bytes, Body &&body) {
+  auto const start = std::chrono::steady_clock::now();
+  size_t const checksum = body();
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::cout << name << ": " << static_cast<size_t>(records / elapsed.count())
+            << " records/s, " << bytes / elapsed.count() / (1 << 20)
+            << " MiB/s (" << elapsed.count() << " s, checksum " << checksum
+            << ")" << std::endl;
+}
+
+}  // namespace
+
+int main() {
+  write_trace();
+  size_t bytes = 0;
+  {
+    std::ifstream in(path, std::ios::ate | std::ios::binary);
+    bytes = static_cast<size_t>(in.tellg());
+  }
+
+  report("ifstream >> + stoull", bytes, []() {
+    std::ifstream fin(path);
+    size_t id = 0;
+    double weight = 0;
+    size_t current_floor = 0;
+    std::string time;
+    size_t target_floor = 0;
+    size_t checksum = 0;
+    while (fin >> id >> weight >> current_floor >> time >> target_floor) {
+      checksum += legacy_time_to_numerical(time) + current_floor + id;
+    }
+    return checksum;
+  });
+
+  report("PassengerFileParser", bytes, []() {
+    PassengerFileParser parser(path);
+    PassengerRecord record;
+    size_t checksum = 0;
+    while (parser.next(record)) {
+      checksum += record.appear_time + record.boarding_floor + record.id;
+    }
+    return checksum;
+  });
+
+  std::remove(path.c_str());
+  return 0;
+}
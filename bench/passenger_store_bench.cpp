@@ -0,0 +1,111 @@
+// Heap bytes per passenger and the cost of walking passengers in arrival
+// order: the std::map keyed by id plus an arrival-ordered pointer vector
+// that ElevatorSystem used before, against PassengerStore.
+
+#include <malloc.h>
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "passenger_store.h"
+
+namespace {
+
+size_t const passengers = 1000000;
+size_t const walks = 20;
+
+// Field layout of Passenger before the hot/cold split.
+struct LegacyPassenger {
+  size_t id;
+  size_t appear_time;
+  size_t boarding_floor;
+  size_t target_floor;
+  double weight;
+  size_t boarding_time = 0;
+  size_t deboarding_time = 0;
+  bool has_overload_lift = false;
+  size_t ride_elevator = 0;
+  size_t ride = RideLog::npos;
+};
+
+size_t heap_in_use() { return mallinfo2().uordblks; }
+
+template <typename Walk>
+void report(char const *name, size_t bytes, Walk &&walk) {
+  auto const start = std::chrono::steady_clock::now();
+  double checksum = 0;
+  for (size_t i = 0; i < walks; ++i) {
+    checksum += walk();
+  }
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::cout << name << ": " << static_cast<double>(bytes) / passengers
+            << " bytes/passenger, "
+            << elapsed.count() * 1e9 / (passengers * walks)
+            << " ns/passenger per walk (checksum " << checksum << ")"
+            << std::endl;
+}
+
+}  // namespace
+
+int main() {
+  std::mt19937_64 random(42);
+  std::vector<LegacyPassenger> input;
+  input.reserve(passengers);
+  for (size_t id = 1; id <= passengers; ++id) {
+    input.push_back({id * 7919 % 1000003, (id * 3) % 10000, 1 + random() % 40,
+                     1 + random() % 40, 40 + (random() % 800) / 10.0});
+  }
+
+  {
+    size_t const before = heap_in_use();
+    std::map<size_t, LegacyPassenger> by_id;
+    std::vector<LegacyPassenger *> arrival_order;
+    for (auto const &passenger : input) {
+      auto [it, inserted] = by_id.emplace(passenger.id, passenger);
+      if (inserted) {
+        arrival_order.push_back(&it->second);
+      }
+    }
+    size_t const bytes = heap_in_use() - before;
+
+    report("std::map + arrival vector", bytes, [&arrival_order]() {
+      double sum = 0;
+      for (auto const *passenger : arrival_order) {
+        sum += passenger->weight + static_cast<double>(passenger->target_floor);
+      }
+      return sum;
+    });
+  }
+
+  {
+    size_t const before = heap_in_use();
+    PassengerStore store;
+    for (auto const &passenger : input) {
+      store.add(passenger.id, passenger.appear_time, passenger.boarding_floor,
+                passenger.target_floor, passenger.weight);
+    }
+    store.release_id_index();
+    size_t const bytes = heap_in_use() - before;
+
+    report("PassengerStore", bytes, [&store]() {
+      double sum = 0;
+      for (std::uint32_t slot = 0; slot < store.slots(); ++slot) {
+        Passenger const &passenger = store.at(slot);
+        sum +=
+            passenger.weight() + static_cast<double>(passenger.target_floor());
+      }
+      return sum;
+    });
+    std::cout << "PassengerStore::memory_usage(): "
+              << static_cast<double>(store.memory_usage()) / passengers
+              << " bytes/passenger" << std::endl;
+  }
+
+  return 0;
+}
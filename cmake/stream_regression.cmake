@@ -0,0 +1,56 @@
+cmake_minimum_required(VERSION 3.16)
+
+# Models the sample files with and without --stream and compares the
+# results. The elevators file has to match byte for byte. Streaming writes
+# passengers in delivery order and logs each record as it appears, so the
+# passengers file only has to hold the same records and runtime.log the same
+# lines.
+#
+# cmake -DMAIN=<main> -DSOURCE_DIR=<repo> -DWORK_DIR=<dir> -P <this file>
+
+foreach(mode normal stream)
+  set(dir ${WORK_DIR}/${mode})
+  file(REMOVE_RECURSE ${dir})
+  file(MAKE_DIRECTORY ${dir}/files)
+
+  set(options)
+  if(mode STREQUAL "stream")
+    set(options --stream)
+  endif()
+  execute_process(
+    COMMAND ${MAIN} ${SOURCE_DIR}/files/elevators.txt
+            ${SOURCE_DIR}/files/passengers.txt passengers.txt elevators.txt
+            ${options}
+    WORKING_DIRECTORY ${dir}
+    RESULT_VARIABLE result
+    OUTPUT_QUIET)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "main ${options} failed: ${result}")
+  endif()
+endforeach()
+
+execute_process(
+  COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK_DIR}/normal/elevators.txt
+          ${WORK_DIR}/stream/elevators.txt
+  RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "elevators.txt differs with --stream")
+endif()
+
+# Records are separated by a blank line.
+foreach(mode normal stream)
+  file(READ ${WORK_DIR}/${mode}/passengers.txt text)
+  string(REPLACE "\n\n" ";" ${mode}_records "${text}")
+  list(SORT ${mode}_records)
+endforeach()
+if(NOT normal_records STREQUAL stream_records)
+  message(FATAL_ERROR "passengers.txt holds other records with --stream")
+endif()
+
+foreach(mode normal stream)
+  file(STRINGS ${WORK_DIR}/${mode}/files/runtime.log ${mode}_lines)
+  list(SORT ${mode}_lines)
+endforeach()
+if(NOT normal_lines STREQUAL stream_lines)
+  message(FATAL_ERROR "runtime.log holds other lines with --stream")
+endif()
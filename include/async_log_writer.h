@@ -0,0 +1,83 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_ASYNC_LOG_WRITER_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_ASYNC_LOG_WRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bounded_ring_buffer.h"
+#include "log_stream_registry.h"
+#include "logger.h"
+
+class async_log_writer final {
+
+public:
+  enum class overflow_policy {
+    block,         // wait until the writer frees a slot
+    drop,          // discard the record silently
+    drop_and_count // discard the record and report the count in the log
+  };
+
+  struct settings {
+    size_t queue_capacity = 8192;
+    overflow_policy policy = overflow_policy::block;
+    std::chrono::milliseconds flush_interval{100};
+    size_t batch_size = 512;
+  };
+
+  using stream_table =
+      std::map<logger::severity, std::vector<shared_log_stream *>>;
+
+private:
+  struct record {
+    std::string message;
+    logger::severity severity = logger::severity::information;
+  };
+
+private:
+  stream_table const _streams;
+  std::set<shared_log_stream *> _all_streams;
+  settings const _settings;
+
+  bounded_ring_buffer<record> _queue;
+  std::atomic<size_t> _dropped{0};
+
+  std::mutex _wake_mutex;
+  std::condition_variable _wake;
+  std::atomic<bool> _writer_waiting{false};
+  bool _stopping = false;
+
+  std::thread _writer;
+
+public:
+  async_log_writer(stream_table streams, settings const &writer_settings);
+
+  ~async_log_writer() noexcept;
+
+  async_log_writer(async_log_writer const &) = delete;
+  async_log_writer &operator=(async_log_writer const &) = delete;
+
+public:
+  void push(std::string &&message, logger::severity severity) noexcept;
+
+private:
+  void run();
+  void wake_writer() noexcept;
+  // Lines are gathered per stream and appended a batch at a time, so they
+  // stay whole next to other loggers writing to the same stream.
+  using pending_lines = std::map<shared_log_stream *, std::string>;
+
+  void write_record(record const &item, pending_lines &pending) const;
+  void report_dropped(pending_lines &pending);
+  static void write_pending(pending_lines &pending,
+                            std::set<shared_log_stream *> &dirty);
+  static void flush_streams(std::set<shared_log_stream *> &dirty);
+};
+
+#endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_ASYNC_LOG_WRITER_H
@@ -0,0 +1,111 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_BOUNDED_RING_BUFFER_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_BOUNDED_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// Bounded multi-producer/multi-consumer queue (Vyukov). Every cell carries a
+// sequence number, so producers and consumers only contend on one counter
+// each and never take a lock.
+template <typename T>
+class bounded_ring_buffer final {
+
+private:
+  struct cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static constexpr size_t cache_line_size = 64;
+
+private:
+  std::unique_ptr<cell[]> _cells;
+  size_t const _mask;
+  alignas(cache_line_size) std::atomic<size_t> _enqueue_position{0};
+  alignas(cache_line_size) std::atomic<size_t> _dequeue_position{0};
+
+public:
+  explicit bounded_ring_buffer(size_t capacity)
+      : _cells(new cell[capacity]), _mask(capacity - 1) {
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+      throw std::invalid_argument(
+          "Ring buffer capacity must be a power of two greater than 1");
+    }
+
+    for (size_t i = 0; i < capacity; ++i) {
+      _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bounded_ring_buffer(bounded_ring_buffer const &) = delete;
+  bounded_ring_buffer &operator=(bounded_ring_buffer const &) = delete;
+
+public:
+  size_t capacity() const noexcept { return _mask + 1; }
+
+  size_t size_approx() const noexcept {
+    size_t const head = _dequeue_position.load(std::memory_order_relaxed);
+    size_t const tail = _enqueue_position.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+  }
+
+  bool try_push(T &&value) {
+    cell *target;
+    size_t position = _enqueue_position.load(std::memory_order_relaxed);
+
+    while (true) {
+      target = &_cells[position & _mask];
+      size_t const sequence = target->sequence.load(std::memory_order_acquire);
+      auto const difference = static_cast<std::ptrdiff_t>(sequence) -
+                              static_cast<std::ptrdiff_t>(position);
+
+      if (difference == 0) {
+        if (_enqueue_position.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = _enqueue_position.load(std::memory_order_relaxed);
+      }
+    }
+
+    target->value = std::move(value);
+    target->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_pop(T &value) {
+    cell *source;
+    size_t position = _dequeue_position.load(std::memory_order_relaxed);
+
+    while (true) {
+      source = &_cells[position & _mask];
+      size_t const sequence = source->sequence.load(std::memory_order_acquire);
+      auto const difference = static_cast<std::ptrdiff_t>(sequence) -
+                              static_cast<std::ptrdiff_t>(position + 1);
+
+      if (difference == 0) {
+        if (_dequeue_position.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = _dequeue_position.load(std::memory_order_relaxed);
+      }
+    }
+
+    value = std::move(source->value);
+    source->sequence.store(position + _mask + 1, std::memory_order_release);
+    return true;
+  }
+};
+
+#endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_BOUNDED_RING_BUFFER_H
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Simulation state as one flat byte image: fixed-size fields in native byte
+// order, back to back, vectors prefixed by their length. An image starts
+// with the magic and version below, and is meant to be read back on the
+// same kind of machine.
+class CheckpointWriter final {
+ public:
+  static constexpr char magic[8] = {'E', 'L', 'V', 'C', 'K', 'P', 'T', '1'};
+  static constexpr std::uint32_t version = 3;
+
+  CheckpointWriter();
+
+  template <typename T>
+    requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+  void put(T value) {
+    append(&value, sizeof(value));
+  }
+
+  // Length, then the elements; T has to be free of padding.
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  void put_vector(std::span<T const> values) {
+    put<std::uint64_t>(values.size());
+    append(values.data(), values.size_bytes());
+  }
+
+  std::vector<char> const &bytes() const noexcept { return m_bytes; }
+  std::vector<char> take() noexcept { return std::move(m_bytes); }
+
+ private:
+  std::vector<char> m_bytes;
+
+  void append(void const *data, size_t size);
+};
+
+// Reads an image written by CheckpointWriter in the same order. Running off
+// the end, a wrong magic or version throw std::runtime_error.
+class CheckpointReader final {
+ public:
+  explicit CheckpointReader(std::span<char const> bytes);
+
+  template <typename T>
+    requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+  T get() {
+    T value;
+    std::memcpy(&value, take(sizeof(value)), sizeof(value));
+    return value;
+  }
+
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  std::vector<T> get_vector() {
+    auto const count = get<std::uint64_t>();
+    if (count > remaining() / sizeof(T)) {
+      throw std::runtime_error("Checkpoint is truncated");
+    }
+    std::vector<T> values(count);
+    std::memcpy(values.data(), take(count * sizeof(T)), count * sizeof(T));
+    return values;
+  }
+
+  size_t remaining() const noexcept { return m_bytes.size() - m_offset; }
+
+ private:
+  std::span<char const> m_bytes;
+  size_t m_offset = 0;
+
+  char const *take(size_t size);
+};
+
+// Writes checkpoint images to files on a thread of its own, so the
+// simulation only pays for building the image. Each file is written under a
+// temporary name and renamed into place, so a crash never leaves a torn
+// checkpoint behind. At most max_pending images wait at a time; save()
+// blocks beyond that instead of piling up memory.
+class CheckpointSaver final {
+ public:
+  static constexpr size_t max_pending = 2;
+
+  CheckpointSaver();
+  // Writes what is still queued. Errors are lost here; call wait() first
+  // to see them.
+  ~CheckpointSaver();
+
+  CheckpointSaver(CheckpointSaver const &) = delete;
+  CheckpointSaver &operator=(CheckpointSaver const &) = delete;
+
+  // Rethrows the first error of an earlier write.
+  void save(std::string file, std::vector<char> image);
+  // Returns once every queued image is written; rethrows the first error.
+  void wait();
+
+  // Synchronous write with the same temporary-file-and-rename steps.
+  static void write_file(std::string const &file,
+                         std::span<char const> image);
+
+ private:
+  struct Job {
+    std::string file;
+    std::vector<char> image;
+  };
+
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::deque<Job> m_jobs;
+  bool m_writing = false;
+  bool m_stopping = false;
+  std::exception_ptr m_error;
+  std::thread m_thread;
+
+  void run();
+  void rethrow_error();
+};
@@ -2,10 +2,14 @@
 #define MATH_PRACTICE_AND_OPERATING_SYSTEMS_CLIENT_LOGGER_H
 
 #include <map>
-#include <ostream>
+#include <memory>
+#include <optional>
 #include <set>
 #include <vector>
 
+#include "async_log_writer.h"
+#include "log_format.h"
+#include "log_stream_registry.h"
 #include "logger.h"
 #include <client_logger_builder.h>
 
@@ -13,20 +17,21 @@ class client_logger final : public logger {
 
   friend class client_logger_builder;
 
-private:
-  static std::map<std::string, std::pair<std::ostream *, size_t>> _all_streams;
-
 private:
   std::map<logger::severity,
-           std::vector<std::pair<std::ostream *, std::string>>>
+           std::vector<std::pair<shared_log_stream *, std::string>>>
       _streams;
-  std::string _log_format;
+  log_format _log_format;
+  std::shared_ptr<async_log_writer> _async_writer;
+  std::optional<mapped_log_file::settings> _mapped_settings;
 
 private:
-  explicit client_logger(
+  client_logger(
       std::map<logger::severity,
                std::pair<std::set<std::string>, std::string>> const &streams,
-      std::string log_format);
+      log_format format,
+      std::optional<async_log_writer::settings> const &async_settings,
+      std::optional<mapped_log_file::settings> const &mapped_settings);
 
 public:
   ~client_logger() override;
@@ -43,11 +48,15 @@ public:
   logger const *log(std::string const &message,
                     logger::severity severity) const noexcept override;
 
+  bool is_enabled(logger::severity severity) const noexcept override;
+
 private:
-  std::string format_log(std::string const &message, logger::severity severity,
-                         time_t current_date_time) const;
-  void cleanup_streams();
-  void increment_stream_refcounts();
+  void format_log(std::string &buffer, std::string const &message,
+                  logger::severity severity, time_t current_date_time) const;
+  // Once per path, however many severities it is used for. If a stream
+  // fails to open, those acquired are released again.
+  void acquire_streams();
+  void release_streams();
 };
 
 #endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_CLIENT_LOGGER_H
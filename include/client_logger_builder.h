@@ -2,16 +2,22 @@
 #define MATH_PRACTICE_AND_OPERATING_SYSTEMS_CLIENT_LOGGER_BUILDER_H
 
 #include <map>
+#include <optional>
 #include <set>
 
+#include "async_log_writer.h"
+#include "log_format.h"
 #include "logger_builder.h"
+#include "mapped_log_file.h"
 
 class client_logger_builder final : public logger_builder {
 
 private:
   std::map<logger::severity, std::pair<std::set<std::string>, std::string>>
       _streams_info;
-  std::string _log_format;
+  log_format _log_format;
+  std::optional<async_log_writer::settings> _async_settings;
+  std::optional<mapped_log_file::settings> _mapped_settings;
 
 public:
   client_logger_builder();
@@ -19,6 +25,18 @@ public:
 public:
   logger_builder *set_log_format(std::string const &format);
 
+  logger_builder *
+  set_async_mode(async_log_writer::settings const &settings = {});
+
+  logger_builder *set_sync_mode();
+
+  // File streams opened by the logger are written as mapped_log_file
+  // segments instead of through std::ofstream.
+  logger_builder *
+  set_mapped_file_mode(mapped_log_file::settings const &settings = {});
+
+  logger_builder *set_stream_file_mode();
+
 public:
   logger_builder *add_file_stream(std::string const &stream_file_path,
                                   logger::severity severity) override;
@@ -35,6 +53,9 @@ public:
 
 private:
   static std::string convert_to_absolute(std::string const &path);
+
+  static async_log_writer::overflow_policy
+  string_to_overflow_policy(std::string const &policy_string);
 };
 
 #endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_CLIENT_LOGGER_BUILDER_H
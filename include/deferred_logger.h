@@ -0,0 +1,35 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_DEFERRED_LOGGER_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_DEFERRED_LOGGER_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "logger.h"
+
+// Holds messages back instead of writing them, so work done on several
+// threads can still be logged in a fixed order: each thread logs into its
+// own deferred_logger, and the owner replays them one after another. It
+// reports the severities of its target as enabled, so lazy messages are
+// only built when the target would take them.
+class deferred_logger final : public logger {
+
+private:
+  logger const *_target = nullptr;
+  mutable std::vector<std::pair<std::string, logger::severity>> _records;
+
+public:
+  explicit deferred_logger(logger const *target = nullptr) noexcept;
+
+public:
+  logger const *log(std::string const &message,
+                    logger::severity severity) const noexcept override;
+
+  bool is_enabled(logger::severity severity) const noexcept override;
+
+public:
+  // Passes the held messages on to the target in order and forgets them.
+  void replay();
+};
+
+#endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_DEFERRED_LOGGER_H
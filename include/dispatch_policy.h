@@ -0,0 +1,393 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "elevator.h"
+#include "fleet_state.h"
+#include "floor_bitset.h"
+
+// What a dispatch policy sees of the building. Elevators only change inside
+// ElevatorSystem, which reports each change through elevator_changed() once
+// the fleet state has it.
+struct DispatchContext {
+  std::vector<Elevator> const &elevators;
+  FleetState &fleet;
+  size_t floors_count;
+};
+
+// Where an elevator heads from a floor; IdleClosed means it stays there.
+struct NextStop {
+  ElevatorState state;
+  size_t floor;
+};
+
+// The decisions ElevatorSystem leaves to its policy. The policy is a
+// template argument, so none of these calls is virtual.
+//
+// assign() picks the elevator for a hall call, or FleetState::npos.
+// can_assign() must hold whenever assign() could succeed, and may only turn
+// from false to true through elevator_changed(); event runs sleep on it.
+// interrupt_floor() is the floor an elevator sent to a hall call plans its
+// route from, next_stop() where it heads after that or after an arrival.
+// next_stop() may only look at the elevator it is given: arrivals of one
+// tick can be handled on several threads at once.
+template <typename Policy>
+concept DispatchPolicy =
+    std::constructible_from<Policy, DispatchContext const &> &&
+    requires(Policy &policy, Policy const &const_policy,
+             Elevator const &elevator, size_t floor, size_t time,
+             size_t index) {
+      { Policy::name } -> std::convertible_to<char const *>;
+      { policy.assign(floor, time) } -> std::same_as<size_t>;
+      { policy.can_assign(floor, time) } -> std::same_as<bool>;
+      { const_policy.interrupt_floor(elevator, time) } -> std::same_as<size_t>;
+      { const_policy.next_stop(elevator, floor) } -> std::same_as<NextStop>;
+      policy.elevator_changed(index);
+    };
+
+// Directional collective control: an elevator keeps its direction while a
+// cabin button lies ahead, then turns around, then idles. Elevators sent to
+// a hall call plan from one floor past their approximate position.
+class CollectiveControl {
+ public:
+  size_t interrupt_floor(Elevator const &elevator, size_t time) const {
+    return elevator.elevator_aproximate_floor(time) + 1;
+  }
+
+  NextStop next_stop(Elevator const &elevator, size_t floor) const {
+    FloorBitset const &buttons = elevator.pressed_buttons();
+    size_t const above = buttons.find_next(floor + 1);
+    size_t const below = buttons.find_prev(floor - 1);
+
+    switch (elevator.state()) {
+      case ElevatorState::MovingUp:
+      case ElevatorState::IdleClosed:
+        if (above != FloorBitset::npos) {
+          return {ElevatorState::MovingUp, above};
+        }
+        if (below != FloorBitset::npos) {
+          return {ElevatorState::MovingDown, below};
+        }
+        break;
+      case ElevatorState::MovingDown:
+        if (below != FloorBitset::npos) {
+          return {ElevatorState::MovingDown, below};
+        }
+        if (above != FloorBitset::npos) {
+          return {ElevatorState::MovingUp, above};
+        }
+        break;
+      case ElevatorState::IdleOpen:
+        break;
+    }
+
+    return {ElevatorState::IdleClosed, floor};
+  }
+
+ protected:
+  static bool is_suitable(ElevatorState state, int approximate_floor,
+                          size_t floor) noexcept {
+    switch (state) {
+      case ElevatorState::IdleClosed:
+      case ElevatorState::IdleOpen:
+        return true;
+      case ElevatorState::MovingUp:
+        return approximate_floor <= static_cast<int>(floor);
+      case ElevatorState::MovingDown:
+        return approximate_floor >= static_cast<int>(floor);
+    }
+
+    return false;
+  }
+};
+
+// CollectiveControl for the newer policies. An elevator that would plan from
+// past the top floor plans from the floor below its position instead, and a
+// moving elevator only counts as approaching a call while it is still short
+// of the floor: one already there would be re-sent every tick, and the
+// passengers it picks up there are only those going its way.
+class BoundedCollectiveControl : public CollectiveControl {
+ public:
+  explicit BoundedCollectiveControl(size_t floors_count)
+      : m_floors_count(floors_count) {}
+
+  size_t interrupt_floor(Elevator const &elevator, size_t time) const {
+    size_t const floor = elevator.elevator_aproximate_floor(time);
+    return floor < m_floors_count ? floor + 1 : floor - 1;
+  }
+
+ protected:
+  static bool is_approaching(ElevatorState state, int approximate_floor,
+                             size_t floor) noexcept {
+    switch (state) {
+      case ElevatorState::IdleClosed:
+      case ElevatorState::IdleOpen:
+        return true;
+      case ElevatorState::MovingUp:
+        return approximate_floor < static_cast<int>(floor);
+      case ElevatorState::MovingDown:
+        return approximate_floor > static_cast<int>(floor);
+    }
+
+    return false;
+  }
+
+  // Whether any elevator is approaching floor, which is when assign() of
+  // each bounded policy succeeds: all of them fall back to the nearest
+  // approaching elevator of the whole fleet.
+  static bool has_approaching(FleetState &fleet, size_t floor, size_t time) {
+    auto const floors = fleet.approximate_floors(time);
+    for (size_t i = 0; i < floors.size(); ++i) {
+      if (is_approaching(fleet.state(i), floors[i], floor)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Nearest approaching elevator among every stride-th one from first, ties
+  // as in NearestSuitableDispatch.
+  static size_t nearest_approaching(FleetState const &fleet,
+                                    std::span<int const> floors, size_t floor,
+                                    size_t first = 0, size_t stride = 1) {
+    size_t chosen = FleetState::npos;
+    int nearest = std::numeric_limits<int>::max();
+
+    for (size_t i = first; i < floors.size(); i += stride) {
+      if (!is_approaching(fleet.state(i), floors[i], floor)) {
+        continue;
+      }
+
+      int const distance = std::abs(floors[i] - static_cast<int>(floor));
+      if (distance < nearest ||
+          (distance == nearest && fleet.preferred(i, chosen))) {
+        nearest = distance;
+        chosen = i;
+      }
+    }
+    return chosen;
+  }
+
+ private:
+  size_t m_floors_count;
+};
+
+// The original dispatcher: the nearest elevator that is idle or already
+// heading towards the call. Ties go to an IdleClosed elevator, then to the
+// larger max load.
+class NearestSuitableDispatch final : public CollectiveControl {
+ public:
+  static constexpr char const name[] = "nearest-suitable";
+
+  explicit NearestSuitableDispatch(DispatchContext const &context)
+      : m_context(context) {}
+
+  size_t assign(size_t floor, size_t time) {
+    size_t const chosen = m_context.fleet.nearest_suitable(floor, time);
+#ifdef DEBUG
+    if (chosen != scan(floor, time)) {
+      throw std::logic_error("Fleet scan disagrees with the elevator scan");
+    }
+#endif
+    return chosen;
+  }
+
+  bool can_assign(size_t floor, size_t time) {
+    return m_context.fleet.has_suitable(floor, time);
+  }
+
+  void elevator_changed(size_t) {}
+
+ private:
+  DispatchContext m_context;
+
+  // Reference choice over the Elevator objects, which the fleet kernels have
+  // to reproduce.
+  size_t scan(size_t floor, size_t time) const {
+    auto const &elevators = m_context.elevators;
+    size_t best = FleetState::npos;
+    int min_distance = std::numeric_limits<int>::max();
+
+    for (size_t i = 0; i < elevators.size(); ++i) {
+      Elevator const &elevator = elevators[i];
+      auto current_floor =
+          static_cast<int>(elevator.elevator_aproximate_floor(time));
+      int distance = std::abs(current_floor - static_cast<int>(floor));
+      if (!is_suitable(elevator.state(), current_floor, floor)) {
+        continue;
+      }
+
+      if (distance == min_distance) {
+        if (elevator.state() == ElevatorState::IdleClosed &&
+            elevators[best].state() != ElevatorState::IdleClosed) {
+          best = i;
+        }
+        if (elevator.max_load() > elevators[best].max_load()) {
+          best = i;
+        }
+      } else if (distance < min_distance) {
+        min_distance = distance;
+        best = i;
+      }
+    }
+
+    return best;
+  }
+};
+
+// The nearest idle elevator; moving ones are only sent when the whole fleet
+// is busy, so a call does not wait on a car that first serves its cabin.
+class IdleFirstDispatch final : public BoundedCollectiveControl {
+ public:
+  static constexpr char const name[] = "idle-first";
+
+  explicit IdleFirstDispatch(DispatchContext const &context)
+      : BoundedCollectiveControl(context.floors_count), m_context(context) {}
+
+  size_t assign(size_t floor, size_t time) {
+    FleetState &fleet = m_context.fleet;
+    auto const floors = fleet.approximate_floors(time);
+    size_t chosen = FleetState::npos;
+    int nearest = std::numeric_limits<int>::max();
+
+    for (size_t i = 0; i < floors.size(); ++i) {
+      if (fleet.state(i) != ElevatorState::IdleClosed &&
+          fleet.state(i) != ElevatorState::IdleOpen) {
+        continue;
+      }
+
+      int const distance = std::abs(floors[i] - static_cast<int>(floor));
+      if (distance < nearest ||
+          (distance == nearest && fleet.preferred(i, chosen))) {
+        nearest = distance;
+        chosen = i;
+      }
+    }
+    return chosen != FleetState::npos
+               ? chosen
+               : nearest_approaching(fleet, floors, floor);
+  }
+
+  bool can_assign(size_t floor, size_t time) {
+    return has_approaching(m_context.fleet, floor, time);
+  }
+
+  void elevator_changed(size_t) {}
+
+ private:
+  DispatchContext m_context;
+};
+
+// Approaching elevators ranked by estimated time of arrival instead of
+// distance: a loaded cabin moves slower (Elevator::calculate_moving_time),
+// so an empty car a floor further away can be there first.
+class EtaDispatch final : public BoundedCollectiveControl {
+ public:
+  static constexpr char const name[] = "eta";
+
+  explicit EtaDispatch(DispatchContext const &context)
+      : BoundedCollectiveControl(context.floors_count), m_context(context) {}
+
+  size_t assign(size_t floor, size_t time) {
+    FleetState &fleet = m_context.fleet;
+    auto const floors = fleet.approximate_floors(time);
+    size_t chosen = FleetState::npos;
+    double best_eta = std::numeric_limits<double>::infinity();
+
+    for (size_t i = 0; i < floors.size(); ++i) {
+      if (!is_approaching(fleet.state(i), floors[i], floor)) {
+        continue;
+      }
+
+      double const eta =
+          std::abs(floors[i] - static_cast<int>(floor)) * time_per_floor(i);
+      if (eta < best_eta || (eta == best_eta && fleet.preferred(i, chosen))) {
+        best_eta = eta;
+        chosen = i;
+      }
+    }
+    return chosen;
+  }
+
+  bool can_assign(size_t floor, size_t time) {
+    return has_approaching(m_context.fleet, floor, time);
+  }
+
+  void elevator_changed(size_t) {}
+
+ private:
+  DispatchContext m_context;
+
+  double time_per_floor(size_t index) const {
+    Elevator const &elevator = m_context.elevators[index];
+    return 3 + std::floor(5 * (elevator.current_load() / elevator.max_load()));
+  }
+};
+
+// The building is split into bands of about ten floors, and elevators are
+// dealt round-robin to the bands. A hall call goes to the nearest approaching
+// elevator of its band, or to the nearest approaching one anywhere when the
+// whole band is busy elsewhere.
+class ZonedDispatch final : public BoundedCollectiveControl {
+ public:
+  static constexpr char const name[] = "zoned";
+  static constexpr size_t floors_per_zone = 10;
+
+  explicit ZonedDispatch(DispatchContext const &context)
+      : BoundedCollectiveControl(context.floors_count),
+        m_context(context),
+        m_zones(std::clamp<size_t>(
+            (context.floors_count + floors_per_zone - 1) / floors_per_zone, 1,
+            std::max<size_t>(context.fleet.size(), 1))) {}
+
+  size_t assign(size_t floor, size_t time) {
+    FleetState &fleet = m_context.fleet;
+    auto const floors = fleet.approximate_floors(time);
+    size_t const zone = std::min(
+        m_zones - 1, (floor - 1) * m_zones / m_context.floors_count);
+    size_t const chosen =
+        nearest_approaching(fleet, floors, floor, zone, m_zones);
+    return chosen != FleetState::npos
+               ? chosen
+               : nearest_approaching(fleet, floors, floor);
+  }
+
+  bool can_assign(size_t floor, size_t time) {
+    return has_approaching(m_context.fleet, floor, time);
+  }
+
+  void elevator_changed(size_t) {}
+
+ private:
+  DispatchContext m_context;
+  size_t m_zones;
+};
+
+// Calls visit.template operator()<Policy>() with the built-in policy called
+// name and returns what it returns, so run-time options can pick a policy.
+template <typename Visit>
+decltype(auto) visit_builtin_policy(std::string_view name, Visit &&visit) {
+  if (name == NearestSuitableDispatch::name) {
+    return visit.template operator()<NearestSuitableDispatch>();
+  }
+  if (name == IdleFirstDispatch::name) {
+    return visit.template operator()<IdleFirstDispatch>();
+  }
+  if (name == EtaDispatch::name) {
+    return visit.template operator()<EtaDispatch>();
+  }
+  if (name == ZonedDispatch::name) {
+    return visit.template operator()<ZonedDispatch>();
+  }
+  throw std::runtime_error("Unknown dispatch policy: " + std::string(name));
+}
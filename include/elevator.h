@@ -3,8 +3,13 @@
 #include <cstdint>
 #include <vector>
 
+#include "floor_bitset.h"
 #include "passenger.h"
 
+class CheckpointReader;
+class CheckpointWriter;
+class PassengerStore;
+
 enum class ElevatorState : std::uint8_t {
   IdleClosed,
   IdleOpen,
@@ -12,6 +17,17 @@ enum class ElevatorState : std::uint8_t {
   MovingDown,
 };
 
+class Elevator;
+
+// Told of every state change of the elevators it is set on.
+class ElevatorObserver {
+ public:
+  virtual ~ElevatorObserver() = default;
+  // The elevator, still in from since the time since, enters to at time.
+  virtual void state_changed(Elevator const &elevator, ElevatorState from,
+                             size_t since, ElevatorState to, size_t time) = 0;
+};
+
 class Elevator final {
  public:
   explicit Elevator(size_t id, int starting_floor, double max_load,
@@ -24,7 +40,8 @@ class Elevator final {
   ElevatorState state() const noexcept;
   double current_load() const noexcept;
   double max_load() const noexcept;
-  std::vector<bool> &pressed_buttons() noexcept;
+  FloorBitset &pressed_buttons() noexcept;
+  FloorBitset const &pressed_buttons() const noexcept;
 
   size_t idle_time() const noexcept;
   size_t moving_time() const noexcept;
@@ -33,8 +50,10 @@ class Elevator final {
   double max_load_reached() const noexcept;
   size_t overloads_count() const noexcept;
   std::vector<Passenger *> &passengers();
+  std::vector<Passenger *> const &passengers() const;
   void calculate_moving_time(size_t current_time);
   size_t time_travel_ends() const;
+  size_t last_state_time() const noexcept;
   size_t id() const;
   void set_floors_passed(size_t floors);
 
@@ -42,6 +61,8 @@ class Elevator final {
   void move_passenger_out(std::vector<Passenger *>::iterator &it);
 
   void set_state(ElevatorState st, size_t current_time);
+  // Not owned, and neither saved nor restored; nullptr to stop.
+  void set_observer(ElevatorObserver *observer) noexcept;
   void set_target_floor(size_t floor);
   void set_current_floor(size_t floor);
   size_t target_floor() const;
@@ -49,13 +70,18 @@ class Elevator final {
   size_t elevator_aproximate_floor(size_t time) const;
   void calculate_moving_time_with_interrupt(size_t m_time, size_t floor);
 
+  // Everything but the id and max load, which come from the elevators file;
+  // riders are stored by slot and looked up in passengers on restore.
+  void save(CheckpointWriter &out) const;
+  void restore(CheckpointReader &in, PassengerStore &passengers);
+
  private:
   size_t m_id;
   size_t m_current_floor;
   ElevatorState m_state;
   double m_current_load;
   const double m_max_load;
-  std::vector<bool> m_pressed_buttons;
+  FloorBitset m_pressed_buttons;
   std::vector<Passenger *> m_passengers;
   size_t m_target_floor = 0;
   size_t m_timestamp_when_last_state_set =
@@ -68,4 +94,6 @@ class Elevator final {
   double m_total_cargo = 0;
   double m_max_load_reached = 0;
   size_t m_overloads_count = 0;
+
+  ElevatorObserver *m_observer = nullptr;
 };
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "elevator.h"
+
+// Reads "<floors> <elevators> <max load>..." and returns the elevators, all
+// idle on floor 1, with the number of floors.
+std::pair<std::vector<Elevator>, size_t> parse_elevators_file(
+    std::string const &file);
+
+// One elevator per max load, numbered from 1 and idle on floor 1.
+std::vector<Elevator> make_elevators(size_t floors_count,
+                                     std::vector<double> const &max_loads);
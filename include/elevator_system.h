@@ -1,52 +1,307 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <list>
-#include <map>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <queue>
+#include <span>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "checkpoint.h"
+#include "deferred_logger.h"
+#include "dispatch_policy.h"
 #include "elevator.h"
+#include "fleet_state.h"
+#include "floor_bitset.h"
+#include "histogram.h"
 #include "logger_guardant.h"
 #include "passenger.h"
+#include "passenger_source.h"
+#include "passenger_store.h"
+#include "passenger_table.h"
+#include "results_writer.h"
+#include "ride_log.h"
+#include "trace_sink.h"
+#include "work_stealing_pool.h"
 
+enum class SimulationMode : std::uint8_t {
+  Tick,   // advance the clock one unit at a time
+  Event,  // jump straight to the next time something can happen
+};
+
+// Wait (appearance to boarding) and travel (boarding to arrival) times of
+// the passengers delivered so far.
+struct PassengerTotals {
+  size_t delivered = 0;
+  size_t total_wait = 0;
+  size_t max_wait = 0;
+  size_t total_travel = 0;
+  size_t max_travel = 0;
+};
+
+// What happened to one passenger; times are 0 for steps not reached.
+struct PassengerResult {
+  size_t id = 0;
+  size_t appear_time = 0;
+  size_t board_time = 0;
+  size_t deboard_time = 0;
+  size_t elevator_id = 0;
+  bool had_overload = false;
+
+  bool operator==(PassengerResult const &) const = default;
+};
+
+// Members are defined in elevator_system.tpp, so any DispatchPolicy can
+// instantiate the system; the built-in ones are compiled once, in
+// elevator_system.cpp.
+template <DispatchPolicy Policy = NearestSuitableDispatch>
 class ElevatorSystem final : private logger_guardant {
  private:
+  // System-wide counters moved by handling one elevator arrival. Parallel
+  // ticks keep one per arriving elevator and add them up afterwards.
+  struct ArrivalTally {
+    PassengerTotals delivered;
+    size_t boarded = 0;
+    size_t boarded_appear_sum = 0;
+    size_t boarded_wait = 0;
+    // Wait and time in the cabin of every passenger delivered.
+    std::vector<std::pair<size_t, size_t>> deliveries;
+  };
+
+  struct Arrival {
+    size_t elevator;  // index in m_elevators
+    size_t floor;
+  };
+
+  // Below this many elevators arriving together, waking the pool costs
+  // more than it saves.
+  static constexpr size_t min_parallel_arrivals = 32;
+  // Passengers per chunk when results are formatted on the pool.
+  static constexpr size_t results_chunk_passengers = 4096;
+
   std::vector<Elevator> m_elevators;  // Owner of elevators, elevators borrow
                                       // pointers to passengers to track info
   size_t const m_floors_count;
   size_t const m_elevators_count;
-  std::map<size_t, Passenger> m_passengers;  // Owner of passengers
+  FleetState m_fleet;  // dispatch fields of m_elevators, must follow it
+  Policy m_policy;     // must follow m_fleet
+  PassengerStore m_passengers;  // Owner of passengers
   std::vector<std::list<Passenger *>> m_waiting_passengers_by_floor;
-  std::vector<bool> m_pending_lift_calls;
+  // Floors with waiting passengers and no elevator sent for them yet
+  FloorBitset m_unassigned_hall_calls;
   int m_remaining_passengers = 0;
   int test_passengers_appeared_on_starting_floors = 0;
   int test_pasengers_succesfully_moved_to_dest = 0;
 
-  std::multimap<size_t, Passenger *> m_time_index;
-  std::set<size_t> m_floors_already_called_elevator;
+  // Loaded passengers are stored in order of appear time, so the next one
+  // to appear is simply the next slot.
+  std::uint32_t m_next_arrival = 0;
+
+  // Streaming runs read one record ahead of the clock instead, and write a
+  // passenger's results and forget them as soon as they are delivered.
+  bool m_streaming = false;
+  std::optional<PassengerSource> m_source;
+  std::optional<PassengerRecord> m_next_record;
+  std::unique_ptr<ResultsWriter> m_streamed_results;
+  FloorBitset m_floors_already_called_elevator;
+  RideLog m_rides;
+  PassengerTotals m_totals;
+  Histogram m_wait_histogram;
+  Histogram m_cabin_histogram;
+  std::vector<Histogram> m_load_histograms;  // indexed like m_elevators
+
+  // Lower bound on the final sum of waits for set_wait_target(): boarded
+  // passengers add their wait, waiting ones at least the time since they
+  // appeared. It never shrinks, and ends equal to m_totals.total_wait.
+  std::optional<double> m_wait_target;
+  size_t m_passenger_count = 0;
+  size_t m_boarded_wait = 0;
+  size_t m_waiting = 0;
+  size_t m_waiting_appear_sum = 0;
+  bool m_stopped_early = false;
 
   size_t m_time = 0;
+  size_t m_time_limit = std::numeric_limits<size_t>::max();
+  SimulationMode m_mode = SimulationMode::Event;
+
+  // Event mode only skips time: it runs whole ticks, at the times queued
+  // here for a passenger appearing, an elevator arriving or a hall call that
+  // can be dispatched.
+  std::priority_queue<size_t, std::vector<size_t>, std::greater<>>
+      m_event_times;
+  std::vector<size_t> m_scheduled_arrivals;  // per elevator, last pushed time
+  size_t m_scheduled_appearance = std::numeric_limits<size_t>::max();
+
+  // Parallel handling of arrivals, see set_threads(). The scratch vectors
+  // are kept between ticks; tallies and logs are indexed like m_arrivals.
+  std::unique_ptr<WorkStealingPool> m_pool;
+  std::vector<Arrival> m_arrivals;          // fleet order
+  std::vector<size_t> m_arrivals_by_floor;  // positions in m_arrivals
+  std::vector<size_t> m_floor_groups;  // group starts in m_arrivals_by_floor
+  std::vector<ArrivalTally> m_arrival_tallies;
+  std::vector<deferred_logger> m_arrival_logs;
+
+  // Periodic checkpoints, see set_checkpoints().
+  size_t m_checkpoint_interval = 0;
+  size_t m_next_checkpoint = 0;
+  std::function<void(size_t, std::vector<char>)> m_checkpoint_sink;
+  std::unique_ptr<CheckpointSaver> m_checkpoint_saver;
+
+  TraceSink *m_trace = nullptr;  // see set_trace()
 
   logger *log = nullptr;
+  // Where the thread handling an arrival in a parallel tick logs to, instead
+  // of log.
+  static inline thread_local logger *arrival_log = nullptr;
 
-  logger *get_logger() const override { return log; }
+  logger *get_logger() const override;
 
+  void load_passengers(std::string const &file);
   void parse_passengers_file(std::string const &file);
+  void load_passenger_trace(std::string const &file);
+  bool add_passenger(size_t id, size_t appear_time, size_t boarding_floor,
+                     size_t target_floor, double weight);
+  void validate_floors(PassengerRecord const &record) const;
+  void log_passenger_record(PassengerRecord const &record) const;
+
+  void open_passenger_source(std::string const &file);
+  void read_next_record();
+  bool has_pending_arrival() const noexcept;
+  size_t next_arrival_time() const noexcept;
+  Passenger *take_next_arrival();
+  bool has_undelivered_passengers() const noexcept;
+  void retire_passenger(Passenger const &passenger);
+  void count_delivery(Passenger const &passenger,
+                      PassengerDetails const &details, ArrivalTally &tally);
+  void apply_tally(ArrivalTally const &tally);
+  void format_passenger_result(std::string &out,
+                               Passenger const &passenger) const;
+  void write_passenger_results(ResultsWriter &writer);
 
-  size_t time_to_numerical(std::string const &time) const;
+  ElevatorSystem &simulate();
+  ElevatorSystem &run();
+  void check_time_limit() const;
+  bool wait_target_missed() const noexcept;
+  void run_ticks();
+  void run_events();
+  void process_tick();
+  void schedule_event(size_t time);
+  void schedule_follow_up_events();
+  bool idle_arrival_changes_state(Elevator const &elevator) const;
+  bool has_suitable_elevator(size_t floor, size_t time);
 
+  void refresh_hall_call(size_t floor);
+  void refresh_elevator(Elevator const &elevator);
   void process_floor_arival(size_t floor, Elevator *elevator);
-  void process_passengers_deboarding(size_t floor, Elevator *elevator);
-  void move_passengers_from_floor_to_elevator(size_t floor, Elevator *elevator);
+  void handle_arrival(size_t floor, Elevator *elevator, ArrivalTally &tally);
+  void process_arrivals_in_parallel();
+  void process_passengers_deboarding(size_t floor, Elevator *elevator,
+                                     ArrivalTally &tally);
+  void move_passengers_from_floor_to_elevator(size_t floor, Elevator *elevator,
+                                              ArrivalTally &tally);
   void calculate_next_elevator_target(size_t floor, Elevator *elevator) const;
   void arrive_passengers(size_t current_time);
   Elevator *calculate_most_suitable_elevator(size_t floor);
   void interrupt_elevator(Elevator *elevator, size_t target_floor) const;
 
+  void save_state(CheckpointWriter &out) const;
+  void restore_state(CheckpointReader &in);
+  static void save_floors(CheckpointWriter &out, FloorBitset const &floors);
+  static void restore_floors(CheckpointReader &in, FloorBitset &floors);
+  void take_due_checkpoint();
+
  public:
   ElevatorSystem(std::vector<Elevator> elevators, size_t floors_count,
                  logger *log);
+  ElevatorSystem &set_mode(SimulationMode mode) noexcept;
+  // Handles the elevators arriving in one tick on this many threads (0 for
+  // every hardware thread) when enough arrive together. Results and logs are
+  // the same as with the default, 1. Ignored when streaming. The results
+  // file is formatted on the same threads.
+  ElevatorSystem &set_threads(size_t threads);
+  // model() throws once the clock passes the limit with passengers still
+  // undelivered; some dispatch policies never deliver some traces.
+  ElevatorSystem &set_time_limit(size_t limit) noexcept;
+  // model() gives up as soon as the mean wait over all passengers is sure
+  // to exceed the target, and stopped_early() turns true. Ignored when
+  // streaming, as the passenger count is not known up front.
+  ElevatorSystem &set_wait_target(double mean_wait) noexcept;
+  // Requires input sorted by appear time. Passenger results are written to
+  // the given file in delivery order while modeling, and print_results()
+  // then only writes the elevators file.
+  ElevatorSystem &stream_passenger_results(
+      std::string const &passengers_file_path);
+  // Streams as above but writes no passenger results at all, so memory does
+  // not grow with the number of passengers; totals and histograms remain.
+  ElevatorSystem &stream_without_passenger_results();
+  // While modeling, tells trace what the elevators and passengers do; it is
+  // not owned and must outlive modeling. Results are the same either way.
+  ElevatorSystem &set_trace(TraceSink *trace);
   ElevatorSystem &model(std::string const &input_file);
+  // Same as the file overload for passengers generated in memory; they need
+  // not be sorted.
+  ElevatorSystem &model(std::span<PassengerRecord const> passengers);
+  // A table is sorted and deduplicated already, so nothing is re-checked.
+  ElevatorSystem &model(PassengerTable const &passengers);
   ElevatorSystem &print_results(std::string const &passengers_file_path,
                                 std::string const &elevators_file_path);
+
+  // While modeling, writes the whole state to "<prefix><time>.ckpt" about
+  // every interval time units, on a background thread. model() and
+  // resume() return once the last of them is on disk. Not for streaming
+  // runs, which do not keep their passengers.
+  ElevatorSystem &set_checkpoints(size_t interval, std::string prefix);
+  // Same, but hands the clock and each image to sink on the modeling thread.
+  ElevatorSystem &set_checkpoints(
+      size_t interval, std::function<void(size_t, std::vector<char>)> sink);
+  // The whole state as of now, as set_checkpoints() writes it.
+  std::vector<char> checkpoint() const;
+  void save_checkpoint(std::string const &file) const;
+  // Loads a checkpoint into a system that has not modeled yet, built from
+  // the same elevators file; max loads and the policy may differ from the
+  // saved run. resume() then models on from there, instead of model().
+  ElevatorSystem &restore(std::span<char const> image);
+  ElevatorSystem &restore(std::string const &file);
+  ElevatorSystem &resume();
+  // Adds passengers to a restored system before resume(), as if they had
+  // been in the passengers file. They may not appear before the clock; ids
+  // already known are skipped, like duplicates in a file.
+  ElevatorSystem &add_passengers(std::span<PassengerRecord const> passengers);
+
+  PassengerTotals const &passenger_totals() const noexcept {
+    return m_totals;
+  }
+  // Kept up to date while modeling: the wait from appearance to boarding
+  // and the time in the cabin of each delivered passenger, and per elevator
+  // its load in percent of the max load whenever passengers got on or off.
+  Histogram const &wait_histogram() const noexcept { return m_wait_histogram; }
+  Histogram const &cabin_histogram() const noexcept {
+    return m_cabin_histogram;
+  }
+  std::vector<Histogram> const &load_histograms() const noexcept {
+    return m_load_histograms;
+  }
+  // The clock; after model() the time at which modeling stopped.
+  size_t time() const noexcept { return m_time; }
+  bool stopped_early() const noexcept { return m_stopped_early; }
+  std::vector<Elevator> const &elevators() const noexcept {
+    return m_elevators;
+  }
+  // One entry per passenger, ordered by id. Not for streaming runs.
+  std::vector<PassengerResult> passenger_results() const;
 };
+
+#include "elevator_system.tpp"
+
+// Instantiated in elevator_system.cpp, so that the files using the built-in
+// policies do not compile the whole system again.
+extern template class ElevatorSystem<NearestSuitableDispatch>;
+extern template class ElevatorSystem<IdleFirstDispatch>;
+extern template class ElevatorSystem<EtaDispatch>;
+extern template class ElevatorSystem<ZonedDispatch>;
@@ -0,0 +1,1475 @@
+#pragma once
+
+// Member definitions of ElevatorSystem, included by elevator_system.h so that
+// any DispatchPolicy can instantiate it.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+#include "elevator.h"
+#include "mapped_file.h"
+#include "passenger_file_parser.h"
+#include "passenger_trace.h"
+#include "phase_profiler.h"
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy>::ElevatorSystem(std::vector<Elevator> elevators,
+                                       size_t floors_count, logger *log)
+    : m_elevators(std::move(elevators)),
+      m_floors_count(floors_count),
+      m_elevators_count(elevators.size()),
+      m_fleet(m_elevators),
+      m_policy(DispatchContext{m_elevators, m_fleet, floors_count}),
+      log(log),
+      m_waiting_passengers_by_floor(floors_count + 1),
+      m_unassigned_hall_calls(floors_count + 1),
+      m_floors_already_called_elevator(floors_count + 1),
+      m_load_histograms(m_elevators.size()) {
+  size_t max_id = 0;
+  for (auto const &elevator : m_elevators) {
+    max_id = std::max(max_id, elevator.id());
+  }
+  m_rides.reserve_elevators(max_id + 1);
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::set_mode(
+    SimulationMode mode) noexcept {
+  m_mode = mode;
+  return *this;
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::set_threads(size_t threads) {
+  m_pool = threads == 1 ? nullptr : std::make_unique<WorkStealingPool>(threads);
+  return *this;
+}
+
+template <DispatchPolicy Policy>
+logger *ElevatorSystem<Policy>::get_logger() const {
+  return arrival_log != nullptr ? arrival_log : log;
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::stream_passenger_results(
+    std::string const &passengers_file_path) {
+  m_streamed_results = std::make_unique<ResultsWriter>(passengers_file_path);
+  if (!m_streamed_results->is_open()) {
+    std::string const error_message =
+        "Failed to open results file: " + passengers_file_path;
+    error_with_guard(error_message);
+    throw std::runtime_error(error_message);
+  }
+
+  m_streaming = true;
+  return *this;
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &
+ElevatorSystem<Policy>::stream_without_passenger_results() {
+  m_streamed_results.reset();
+  m_streaming = true;
+  return *this;
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::model(
+    std::string const &input_file) {
+  if (m_streaming) {
+    open_passenger_source(input_file);
+  } else {
+    load_passengers(input_file);
+  }
+  return simulate();
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::model(
+    std::span<PassengerRecord const> passengers) {
+  if (m_streaming) {
+    std::string const error_message =
+        "Streaming runs read their passengers from a file";
+    error_with_guard(error_message);
+    throw std::runtime_error(error_message);
+  }
+
+  try {
+    for (PassengerRecord const &record : passengers) {
+      validate_floors(record);
+      if (add_passenger(record.id, record.appear_time, record.boarding_floor,
+                        record.target_floor, record.weight)) {
+        log_passenger_record(record);
+      }
+    }
+  } catch (std::runtime_error const &e) {
+    error_with_guard(e.what());
+    throw;
+  }
+  m_passengers.release_id_index();
+  m_passengers.sort_by_appear_time();
+  return simulate();
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::model(
+    PassengerTable const &passengers) {
+  if (m_streaming) {
+    std::string const error_message =
+        "Streaming runs read their passengers from a file";
+    error_with_guard(error_message);
+    throw std::runtime_error(error_message);
+  }
+
+  try {
+    m_passengers.release_id_index();
+    for (PassengerRecord const &record : passengers.records()) {
+      validate_floors(record);
+      add_passenger(record.id, record.appear_time, record.boarding_floor,
+                    record.target_floor, record.weight);
+    }
+  } catch (std::runtime_error const &e) {
+    error_with_guard(e.what());
+    throw;
+  }
+  return simulate();
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::simulate() {
+  m_passenger_count = m_passengers.size();
+  information_with_guard([] {
+    return "Modeling starts!\n"
+           "-----------------------------------------------------------";
+  });
+  return run();
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::run() {
+  if (m_checkpoint_sink) {
+    if (m_streaming) {
+      std::string const error_message =
+          "Streaming runs can not write checkpoints";
+      error_with_guard(error_message);
+      throw std::runtime_error(error_message);
+    }
+    m_next_checkpoint =
+        (m_time / m_checkpoint_interval + 1) * m_checkpoint_interval;
+  }
+
+  {
+    PROFILE_PHASE(timer, Phase::Model);
+    [[maybe_unused]] size_t const delivered = m_totals.delivered;
+    if (m_mode == SimulationMode::Tick) {
+      run_ticks();
+    } else {
+      run_events();
+    }
+    PROFILE_ITEMS(timer, m_totals.delivered - delivered);
+  }
+
+  for (auto &e : m_elevators) {
+    e.set_state(ElevatorState::IdleClosed, m_time);
+  }
+
+  if (m_checkpoint_saver) {
+    m_checkpoint_saver->wait();
+  }
+  return *this;
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::set_trace(TraceSink *trace) {
+  m_trace = trace;
+  for (auto &elevator : m_elevators) {
+    elevator.set_observer(trace);
+    if (trace != nullptr) {
+      trace->add_elevator(elevator);
+    }
+  }
+  return *this;
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::set_time_limit(
+    size_t limit) noexcept {
+  m_time_limit = limit;
+  return *this;
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::set_wait_target(
+    double mean_wait) noexcept {
+  m_wait_target = mean_wait;
+  return *this;
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::set_checkpoints(
+    size_t interval, std::string prefix) {
+  if (!m_checkpoint_saver) {
+    m_checkpoint_saver = std::make_unique<CheckpointSaver>();
+  }
+  return set_checkpoints(
+      interval, [saver = m_checkpoint_saver.get(), prefix = std::move(prefix)](
+                    size_t time, std::vector<char> image) {
+        saver->save(prefix + std::to_string(time) + ".ckpt", std::move(image));
+      });
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::set_checkpoints(
+    size_t interval, std::function<void(size_t, std::vector<char>)> sink) {
+  if (interval == 0) {
+    throw std::invalid_argument("Checkpoint interval must be positive");
+  }
+  m_checkpoint_interval = interval;
+  m_checkpoint_sink = std::move(sink);
+  return *this;
+}
+
+template <DispatchPolicy Policy>
+std::vector<char> ElevatorSystem<Policy>::checkpoint() const {
+  if (m_streaming) {
+    throw std::runtime_error("Streaming runs can not write checkpoints");
+  }
+  CheckpointWriter out;
+  save_state(out);
+  return out.take();
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::save_checkpoint(std::string const &file) const {
+  CheckpointSaver::write_file(file, checkpoint());
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::restore(
+    std::span<char const> image) {
+  if (m_streaming || m_time != 0 || m_passengers.slots() != 0) {
+    throw std::logic_error(
+        "Checkpoints are restored into a system that has not modeled yet");
+  }
+
+  try {
+    CheckpointReader in(image);
+    restore_state(in);
+  } catch (std::runtime_error const &e) {
+    error_with_guard(e.what());
+    throw;
+  }
+
+  information_with_guard([&] {
+    return "Restored checkpoint at [" + std::to_string(m_time) + "]: " +
+           std::to_string(m_remaining_passengers) +
+           " passengers not delivered yet";
+  });
+  return *this;
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::restore(
+    std::string const &file) {
+  MappedFile const mapped(file);
+  return restore(std::span<char const>(mapped.data(), mapped.size()));
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::resume() {
+  information_with_guard([&] {
+    return "Modeling resumes at [" + std::to_string(m_time) + "]\n"
+           "-----------------------------------------------------------";
+  });
+  return run();
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::add_passengers(
+    std::span<PassengerRecord const> passengers) {
+  if (m_streaming) {
+    std::string const error_message =
+        "Streaming runs read their passengers from a file";
+    error_with_guard(error_message);
+    throw std::runtime_error(error_message);
+  }
+
+  std::unordered_set<size_t> ids;
+  ids.reserve(m_passengers.size() + passengers.size());
+  for (std::uint32_t slot = 0; slot < m_passengers.slots(); ++slot) {
+    ids.insert(m_passengers.details(m_passengers.at(slot)).id);
+  }
+
+  try {
+    for (PassengerRecord const &record : passengers) {
+      validate_floors(record);
+      if (record.appear_time < m_time) {
+        throw std::runtime_error(
+            "Passenger " + std::to_string(record.id) + " appears at [" +
+            std::to_string(record.appear_time) + "], before the clock [" +
+            std::to_string(m_time) + "]");
+      }
+      if (ids.insert(record.id).second &&
+          add_passenger(record.id, record.appear_time, record.boarding_floor,
+                        record.target_floor, record.weight)) {
+        ++m_passenger_count;
+        log_passenger_record(record);
+      }
+    }
+  } catch (std::runtime_error const &e) {
+    error_with_guard(e.what());
+    throw;
+  }
+
+  // Only passengers yet to appear move; the rest are pointed to already.
+  m_passengers.sort_by_appear_time(m_next_arrival);
+  return *this;
+}
+
+template <DispatchPolicy Policy>
+std::vector<PassengerResult> ElevatorSystem<Policy>::passenger_results()
+    const {
+  std::vector<PassengerResult> results;
+  results.reserve(m_passengers.size());
+  for (std::uint32_t slot : m_passengers.slots_by_id()) {
+    Passenger const &passenger = m_passengers.at(slot);
+    PassengerDetails const &details = m_passengers.details(passenger);
+    PassengerResult &result = results.emplace_back();
+    result.id = details.id;
+    result.appear_time = passenger.appear_time();
+    result.deboard_time = details.deboarding_time;
+    result.had_overload = details.had_overload;
+    if (details.ride != RideLog::npos) {
+      result.board_time =
+          m_rides.ride(details.ride_elevator, details.ride).board_time;
+      result.elevator_id = details.ride_elevator;
+    }
+  }
+  return results;
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::take_due_checkpoint() {
+  if (!m_checkpoint_sink || m_time < m_next_checkpoint) {
+    return;
+  }
+
+  PROFILE_PHASE(timer, Phase::Checkpoint);
+  m_checkpoint_sink(m_time, checkpoint());
+  m_next_checkpoint =
+      (m_time / m_checkpoint_interval + 1) * m_checkpoint_interval;
+}
+
+template <DispatchPolicy Policy>
+bool ElevatorSystem<Policy>::wait_target_missed() const noexcept {
+  if (!m_wait_target || m_streaming) {
+    return false;
+  }
+
+  size_t const wait_bound =
+      m_boarded_wait + (m_waiting * m_time) - m_waiting_appear_sum;
+  return static_cast<double>(wait_bound) >
+         *m_wait_target * static_cast<double>(m_passenger_count);
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::check_time_limit() const {
+  if (m_time > m_time_limit) {
+    std::string const error_message =
+        "Simulation passed the time limit at [" + std::to_string(m_time) +
+        "]: " + std::to_string(m_remaining_passengers) +
+        " passengers still not delivered";
+    error_with_guard(error_message);
+    throw std::runtime_error(error_message);
+  }
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::run_ticks() {
+  while (has_undelivered_passengers()) {
+    check_time_limit();
+    if (wait_target_missed()) {
+      m_stopped_early = true;
+      return;
+    }
+    process_tick();
+    ++m_time;
+    take_due_checkpoint();
+  }
+}
+
+// Runs the same per-tick logic as run_ticks(), but only for the ticks in
+// which something can change. A skipped tick would only have accumulated
+// idle time, which is additive, so results are identical to the tick mode.
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::run_events() {
+  // A run resumed from an event-mode checkpoint has its events restored;
+  // scheduling again only adds what passengers added since then need.
+  if (m_scheduled_arrivals.empty()) {
+    m_scheduled_arrivals.assign(m_elevators.size(),
+                                std::numeric_limits<size_t>::max());
+  }
+  schedule_follow_up_events();
+
+  while (has_undelivered_passengers()) {
+    if (m_event_times.empty()) {
+      std::string const error_message =
+          "Simulation stalled at [" + std::to_string(m_time) + "]: " +
+          std::to_string(m_remaining_passengers) +
+          " passengers can not be delivered";
+      error_with_guard(error_message);
+      throw std::runtime_error(error_message);
+    }
+
+    m_time = m_event_times.top();
+    while (!m_event_times.empty() && m_event_times.top() == m_time) {
+      m_event_times.pop();
+    }
+    check_time_limit();
+    if (wait_target_missed()) {
+      m_stopped_early = true;
+      return;
+    }
+
+    process_tick();
+    ++m_time;
+    schedule_follow_up_events();
+    take_due_checkpoint();
+  }
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::process_tick() {
+  PROFILE_PHASE(timer, Phase::Tick);
+  arrive_passengers(m_time);
+  {
+    PROFILE_PHASE(dispatch_timer, Phase::Dispatch);
+    // Handling a floor only changes the bits of that floor, so the walk can
+    // read the live set as it goes.
+    for (size_t i = m_unassigned_hall_calls.find_next(1);
+         i != FloorBitset::npos;
+         i = m_unassigned_hall_calls.find_next(i + 1)) {
+      Elevator *e = calculate_most_suitable_elevator(i);
+      if (e != nullptr) {
+        PROFILE_ITEMS(dispatch_timer, 1);
+        m_floors_already_called_elevator.set(i);
+        m_unassigned_hall_calls.reset(i);
+        if (e->current_floor() == i &&
+            (e->state() == ElevatorState::IdleClosed)) {
+          process_floor_arival(i, e);
+        } else {
+          interrupt_elevator(e, i);
+        }
+        refresh_elevator(*e);
+      }
+    }
+  }
+
+  PROFILE_PHASE(arrivals_timer, Phase::FloorArrivals);
+  if (m_pool && !m_streaming) {
+    process_arrivals_in_parallel();
+    PROFILE_ITEMS(arrivals_timer, m_arrivals.size());
+    return;
+  }
+  for (auto &e : m_elevators) {
+    if (m_time >= e.time_travel_ends() && e.target_floor() > 0) {
+      PROFILE_ITEMS(arrivals_timer, 1);
+      process_floor_arival(e.target_floor(), &e);
+      refresh_elevator(e);
+    }
+  }
+}
+
+// Elevators arriving at different floors only share the counters in
+// ArrivalTally, the log and the hall call bits. Elevators bound for the same
+// floor also share its queue, so they form one task and go in fleet order.
+// Counters, logs and elevator updates are then merged in fleet order, and
+// the hall calls of the floors refreshed, which is what the sequential loop
+// leaves behind.
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::process_arrivals_in_parallel() {
+  m_arrivals.clear();
+  for (size_t i = 0; i < m_elevators.size(); ++i) {
+    Elevator const &e = m_elevators[i];
+    if (m_time >= e.time_travel_ends() && e.target_floor() > 0) {
+      m_arrivals.push_back({i, e.target_floor()});
+    }
+  }
+
+  if (m_arrivals.size() < min_parallel_arrivals) {
+    for (Arrival const &arrival : m_arrivals) {
+      process_floor_arival(arrival.floor, &m_elevators[arrival.elevator]);
+      refresh_elevator(m_elevators[arrival.elevator]);
+    }
+    return;
+  }
+
+  auto const floor_of = [this](size_t position) {
+    return m_arrivals[position].floor;
+  };
+  m_arrivals_by_floor.resize(m_arrivals.size());
+  std::iota(m_arrivals_by_floor.begin(), m_arrivals_by_floor.end(), 0);
+  std::stable_sort(
+      m_arrivals_by_floor.begin(), m_arrivals_by_floor.end(),
+      [&](size_t a, size_t b) { return floor_of(a) < floor_of(b); });
+  m_floor_groups.clear();
+  for (size_t k = 0; k < m_arrivals_by_floor.size(); ++k) {
+    if (k == 0 || floor_of(m_arrivals_by_floor[k]) !=
+                      floor_of(m_arrivals_by_floor[k - 1])) {
+      m_floor_groups.push_back(k);
+    }
+  }
+  m_floor_groups.push_back(m_arrivals_by_floor.size());
+
+  m_arrival_tallies.assign(m_arrivals.size(), ArrivalTally{});
+  if (log != nullptr && m_arrival_logs.size() < m_arrivals.size()) {
+    m_arrival_logs.resize(m_arrivals.size(), deferred_logger(log));
+  }
+
+  m_pool->run(m_floor_groups.size() - 1, [this](size_t group) {
+    for (size_t k = m_floor_groups[group]; k < m_floor_groups[group + 1];
+         ++k) {
+      size_t const position = m_arrivals_by_floor[k];
+      Arrival const &arrival = m_arrivals[position];
+      arrival_log = log != nullptr ? &m_arrival_logs[position] : nullptr;
+      try {
+        handle_arrival(arrival.floor, &m_elevators[arrival.elevator],
+                       m_arrival_tallies[position]);
+      } catch (...) {
+        arrival_log = nullptr;
+        throw;
+      }
+    }
+    arrival_log = nullptr;
+  });
+
+  for (size_t position = 0; position < m_arrivals.size(); ++position) {
+    if (log != nullptr) {
+      m_arrival_logs[position].replay();
+    }
+    apply_tally(m_arrival_tallies[position]);
+    refresh_elevator(m_elevators[m_arrivals[position].elevator]);
+  }
+  for (size_t group = 0; group + 1 < m_floor_groups.size(); ++group) {
+    size_t const floor = floor_of(m_arrivals_by_floor[m_floor_groups[group]]);
+    m_floors_already_called_elevator.reset(floor);
+    refresh_hall_call(floor);
+  }
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::schedule_event(size_t time) {
+  m_event_times.push(time);
+}
+
+// Called with m_time already advanced to the next tick. Stale events are
+// harmless (they only cause a tick without effect), missing ones are not.
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::schedule_follow_up_events() {
+  PROFILE_PHASE(timer, Phase::EventScheduling);
+  if (has_pending_arrival()) {
+    size_t const appear_time = std::max(m_time, next_arrival_time());
+    if (m_scheduled_appearance != appear_time) {
+      m_scheduled_appearance = appear_time;
+      schedule_event(appear_time);
+    }
+  }
+
+  for (size_t i = 0; i < m_elevators.size(); ++i) {
+    Elevator const &e = m_elevators[i];
+    if (e.target_floor() == 0) {
+      continue;
+    }
+
+    bool const moving = e.state() == ElevatorState::MovingUp ||
+                        e.state() == ElevatorState::MovingDown;
+    if (!moving && !idle_arrival_changes_state(e)) {
+      continue;
+    }
+
+    size_t const arrival_time = std::max(m_time, e.time_travel_ends());
+    if (m_scheduled_arrivals[i] != arrival_time) {
+      m_scheduled_arrivals[i] = arrival_time;
+      schedule_event(arrival_time);
+    }
+  }
+
+  for (size_t floor = m_unassigned_hall_calls.find_next(1);
+       floor != FloorBitset::npos;
+       floor = m_unassigned_hall_calls.find_next(floor + 1)) {
+    if (has_suitable_elevator(floor, m_time)) {
+      schedule_event(m_time);  // the tick dispatches every floor it can
+      break;
+    }
+  }
+}
+
+// An idle elevator with a target "arrives" again on every tick; usually that
+// changes nothing but idle time, and such ticks can be skipped.
+template <DispatchPolicy Policy>
+bool ElevatorSystem<Policy>::idle_arrival_changes_state(
+    Elevator const &elevator) const {
+  size_t const floor = elevator.target_floor();
+  if (elevator.state() != ElevatorState::IdleClosed ||
+      elevator.current_floor() != floor ||
+      floor >= m_waiting_passengers_by_floor.size() ||
+      !m_waiting_passengers_by_floor[floor].empty() ||
+      m_floors_already_called_elevator.test(floor)) {
+    return true;
+  }
+
+  if (elevator.pressed_buttons().any()) {
+    return true;
+  }
+
+  auto const &passengers = elevator.passengers();
+  return std::any_of(passengers.begin(), passengers.end(),
+                     [floor](Passenger const *p) {
+                       return p->target_floor() == floor;
+                     });
+}
+
+// Suitability only shrinks while elevators keep their state, so a floor that
+// has no suitable elevator now has none until some elevator changes state.
+template <DispatchPolicy Policy>
+bool ElevatorSystem<Policy>::has_suitable_elevator(size_t floor, size_t time) {
+  return m_policy.can_assign(floor, time);
+}
+
+template <DispatchPolicy Policy>
+ElevatorSystem<Policy> &ElevatorSystem<Policy>::print_results(
+    std::string const &passengers_file_path,
+    std::string const &elevators_file_path) {
+  PROFILE_PHASE(timer, Phase::Results);
+  if (m_streaming) {
+    if (m_streamed_results) {
+      m_streamed_results->close();
+    }
+  } else {
+    ResultsWriter passengers_file(passengers_file_path);
+    if (passengers_file.is_open()) {
+      write_passenger_results(passengers_file);
+      passengers_file.close();
+      PROFILE_ITEMS(timer, m_passengers.size());
+    }
+  }
+
+  std::ofstream elevators_file(elevators_file_path);
+  if (elevators_file.is_open()) {
+    for (auto const &elevator : m_elevators) {
+      elevators_file << "Elevator " << elevator.id() << ":\n";
+      elevators_file << "  Idle time: " << elevator.idle_time() << "\n";
+      elevators_file << "  Moving time: " << m_time - elevator.idle_time()
+                     << "\n";
+      elevators_file << "  Floors passed: " << elevator.floors_passed() << "\n";
+      elevators_file << "  Total cargo: " << elevator.total_cargo() << "\n";
+      elevators_file << "  Max load reached: " << elevator.max_load_reached()
+                     << "\n";
+      elevators_file << "  Overloads count: " << elevator.overloads_count()
+                     << "\n\n";
+    }
+    elevators_file.close();
+  }
+
+  return *this;
+}
+
+// Chunks of passengers in id order are formatted a window at a time, on the
+// pool if there is one, and queued in order; the writer thread writes one
+// window while the next one is formatted.
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::write_passenger_results(ResultsWriter &writer) {
+  std::vector<std::uint32_t> const slots = m_passengers.slots_by_id();
+  size_t const chunks = (slots.size() + results_chunk_passengers - 1) /
+                        results_chunk_passengers;
+  size_t const window = m_pool ? 2 * m_pool->threads() : 1;
+  std::vector<std::string> texts(window);
+
+  auto const format_chunk = [&](size_t chunk, std::string &text) {
+    size_t const begin = chunk * results_chunk_passengers;
+    size_t const end = std::min(begin + results_chunk_passengers, slots.size());
+    text.clear();
+    for (size_t k = begin; k < end; ++k) {
+      format_passenger_result(text, m_passengers.at(slots[k]));
+    }
+  };
+
+  for (size_t first = 0; first < chunks; first += window) {
+    size_t const count = std::min(window, chunks - first);
+    if (count > 1) {
+      m_pool->run(count, [&](size_t i) { format_chunk(first + i, texts[i]); });
+    } else {
+      format_chunk(first, texts[0]);
+    }
+    for (size_t i = 0; i < count; ++i) {
+      writer.write(std::move(texts[i]));
+    }
+  }
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::format_passenger_result(
+    std::string &out, Passenger const &passenger) const {
+  PassengerDetails const &details = m_passengers.details(passenger);
+  out += "Passenger ";
+  append_number(out, details.id);
+  out += ":\n  Appearance time: ";
+  append_number(out, passenger.appear_time());
+  out += "\n  Origin floor: ";
+  append_number(out, passenger.boarding_floor());
+  out += "\n  Target floor: ";
+  append_number(out, passenger.target_floor());
+  out += "\n  Boarding time: ";
+  append_number(out, details.boarding_time);
+  out += "\n  Total travel time: ";
+  append_number(out, details.deboarding_time - details.boarding_time);
+
+  out += "\n  Met passengers: ";
+  bool first = true;
+  auto const met_passengers =
+      m_rides.met_passengers(details.ride_elevator, details.ride);
+  for (size_t met_passenger_id : met_passengers) {
+    if (!first) {
+      out += ", ";
+    }
+    append_number(out, met_passenger_id);
+    first = false;
+  }
+
+  out += "\n  Had overload: ";
+  out += details.had_overload ? "yes" : "no";
+  out += "\n\n";
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::load_passengers(std::string const &file) {
+  PROFILE_PHASE(timer, Phase::Load);
+  if (PassengerTrace::is_binary_trace(file)) {
+    load_passenger_trace(file);
+    m_passengers.release_id_index();
+    PROFILE_ITEMS(timer, m_passengers.size());
+    return;
+  }
+
+  parse_passengers_file(file);
+  m_passengers.release_id_index();
+  m_passengers.sort_by_appear_time();
+  PROFILE_ITEMS(timer, m_passengers.size());
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::parse_passengers_file(std::string const &file) {
+  try {
+    PassengerFileParser parser(file);
+    PassengerRecord record;
+
+    while (parser.next(record)) {
+      validate_floors(record);
+      if (add_passenger(record.id, record.appear_time, record.boarding_floor,
+                        record.target_floor, record.weight)) {
+        log_passenger_record(record);
+      }
+    }
+  } catch (std::runtime_error const &e) {
+    error_with_guard(e.what());
+    throw;
+  }
+}
+
+// Binary traces are already sorted by appear time and deduplicated, so the
+// columns are walked in order and no index has to be built.
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::load_passenger_trace(std::string const &file) {
+  try {
+    PassengerTrace const trace(file);
+    auto const ids = trace.ids();
+    auto const weights = trace.weights();
+    auto const boarding_floors = trace.boarding_floors();
+    auto const appear_times = trace.appear_times();
+    auto const target_floors = trace.target_floors();
+
+    for (size_t i = 0; i < trace.size(); ++i) {
+      validate_floors({.id = ids[i],
+                       .boarding_floor = boarding_floors[i],
+                       .target_floor = target_floors[i],
+                       .time_text = {}});
+      if (i > 0 && appear_times[i] < appear_times[i - 1]) {
+        throw std::runtime_error(
+            "Passenger trace is not sorted by appear time: " + file);
+      }
+
+      add_passenger(ids[i], appear_times[i], boarding_floors[i],
+                    target_floors[i], weights[i]);
+    }
+
+    information_with_guard([&] {
+      return "Loaded " + std::to_string(trace.size()) +
+             " passengers from binary trace " + file;
+    });
+  } catch (std::runtime_error const &e) {
+    error_with_guard(e.what());
+    throw;
+  }
+}
+
+template <DispatchPolicy Policy>
+bool ElevatorSystem<Policy>::add_passenger(size_t id, size_t appear_time,
+                                           size_t boarding_floor,
+                                           size_t target_floor, double weight) {
+  if (m_passengers.add(id, appear_time, boarding_floor, target_floor,
+                       weight) == nullptr) {
+    return false;
+  }
+
+  ++m_remaining_passengers;
+  return true;
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::validate_floors(
+    PassengerRecord const &record) const {
+  if (record.boarding_floor > m_floors_count ||
+      record.target_floor > m_floors_count) {
+    throw std::runtime_error(
+        "Invalid floor number for passenger " + std::to_string(record.id) +
+        ": current_floor=" + std::to_string(record.boarding_floor) +
+        ", target_floor=" + std::to_string(record.target_floor) +
+        " (building has only " + std::to_string(m_floors_count) + " floors)" +
+        (record.line > 0 ? " (line " + std::to_string(record.line) + ")"
+                         : std::string()));
+  }
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::log_passenger_record(
+    PassengerRecord const &record) const {
+  information_with_guard([&] {
+    std::string time_text(record.time_text);
+    if (time_text.empty()) {
+      size_t const minutes = record.appear_time % 60;
+      time_text = std::to_string(record.appear_time / 60) +
+                  (minutes < 10 ? ":0" : ":") + std::to_string(minutes);
+    }
+
+    return "Passenger #" + std::to_string(record.id) + " | " +
+           std::to_string(record.weight) + " kg" + " | " + time_text +
+           " | floor " + std::to_string(record.boarding_floor) + " → floor " +
+           std::to_string(record.target_floor);
+  });
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::open_passenger_source(std::string const &file) {
+  try {
+    m_source.emplace(file);
+    read_next_record();
+  } catch (std::runtime_error const &e) {
+    error_with_guard(e.what());
+    throw;
+  }
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::read_next_record() {
+  PassengerRecord record;
+  if (!m_source->next(record)) {
+    m_next_record.reset();
+    m_source.reset();
+    return;
+  }
+
+  validate_floors(record);
+  m_next_record = record;
+}
+
+template <DispatchPolicy Policy>
+bool ElevatorSystem<Policy>::has_pending_arrival() const noexcept {
+  return m_streaming ? m_next_record.has_value()
+                     : m_next_arrival < m_passengers.slots();
+}
+
+template <DispatchPolicy Policy>
+size_t ElevatorSystem<Policy>::next_arrival_time() const noexcept {
+  return m_streaming ? m_next_record->appear_time
+                     : m_passengers.at(m_next_arrival).appear_time();
+}
+
+// Returns nullptr for a streamed record whose id belongs to a passenger
+// still in the building; like the loaders, the first record wins. Ids of
+// delivered passengers are forgotten and may be reused.
+template <DispatchPolicy Policy>
+Passenger *ElevatorSystem<Policy>::take_next_arrival() {
+  if (!m_streaming) {
+    return &m_passengers.at(m_next_arrival++);
+  }
+
+  PassengerRecord record = *m_next_record;
+  // time_text points into the source, which read_next_record() closes at
+  // the end of the input.
+  std::string const time_text(record.time_text);
+  record.time_text = time_text;
+  try {
+    read_next_record();
+  } catch (std::runtime_error const &e) {
+    error_with_guard(e.what());
+    throw;
+  }
+
+  Passenger *passenger =
+      m_passengers.add(record.id, record.appear_time, record.boarding_floor,
+                       record.target_floor, record.weight);
+  if (passenger == nullptr) {
+    return nullptr;
+  }
+
+  ++m_remaining_passengers;
+  log_passenger_record(record);
+  return passenger;
+}
+
+template <DispatchPolicy Policy>
+bool ElevatorSystem<Policy>::has_undelivered_passengers() const noexcept {
+  return m_remaining_passengers > 0 || has_pending_arrival();
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::retire_passenger(Passenger const &passenger) {
+  size_t const elevator_id = m_passengers.details(passenger).ride_elevator;
+  if (m_streamed_results) {
+    format_passenger_result(m_streamed_results->text(), passenger);
+    m_streamed_results->commit();
+  }
+  m_passengers.remove(passenger);
+  m_rides.release_settled(elevator_id);
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::count_delivery(Passenger const &passenger,
+                                            PassengerDetails const &details,
+                                            ArrivalTally &tally) {
+  size_t const boarded =
+      m_rides.ride(details.ride_elevator, details.ride).board_time;
+  size_t const wait = boarded - passenger.appear_time();
+  size_t const travel = m_time - boarded;
+
+  PassengerTotals &totals = tally.delivered;
+  ++totals.delivered;
+  totals.total_wait += wait;
+  totals.max_wait = std::max(totals.max_wait, wait);
+  totals.total_travel += travel;
+  totals.max_travel = std::max(totals.max_travel, travel);
+  tally.deliveries.emplace_back(wait, travel);
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::apply_tally(ArrivalTally const &tally) {
+  PassengerTotals const &delivered = tally.delivered;
+  m_totals.delivered += delivered.delivered;
+  m_totals.total_wait += delivered.total_wait;
+  m_totals.max_wait = std::max(m_totals.max_wait, delivered.max_wait);
+  m_totals.total_travel += delivered.total_travel;
+  m_totals.max_travel = std::max(m_totals.max_travel, delivered.max_travel);
+  m_remaining_passengers -= static_cast<int>(delivered.delivered);
+  test_pasengers_succesfully_moved_to_dest +=
+      static_cast<int>(delivered.delivered);
+
+  m_waiting -= tally.boarded;
+  m_waiting_appear_sum -= tally.boarded_appear_sum;
+  m_boarded_wait += tally.boarded_wait;
+  for (auto const &[wait, travel] : tally.deliveries) {
+    m_wait_histogram.record(wait);
+    m_cabin_histogram.record(travel);
+  }
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::refresh_hall_call(size_t floor) {
+  m_unassigned_hall_calls.assign(
+      floor, !m_waiting_passengers_by_floor[floor].empty() &&
+                 !m_floors_already_called_elevator.test(floor));
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::refresh_elevator(Elevator const &elevator) {
+  size_t const index = &elevator - m_elevators.data();
+  m_fleet.update(index, elevator);
+  m_policy.elevator_changed(index);
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::process_floor_arival(size_t floor,
+                                                  Elevator *elevator) {
+  ArrivalTally tally;
+  handle_arrival(floor, elevator, tally);
+  apply_tally(tally);
+  m_floors_already_called_elevator.reset(floor);
+  refresh_hall_call(floor);
+}
+
+// Touches the elevator, its load histogram, the queue of the floor and the
+// passengers in either, and nothing else of the system but tally and the
+// log.
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::handle_arrival(size_t floor, Elevator *elevator,
+                                            ArrivalTally &tally) {
+  if (elevator == nullptr) {
+    throw std::invalid_argument("Null elevator pointer (process_floor_arival)");
+  }
+  if (floor >= m_waiting_passengers_by_floor.size()) {
+    throw std::out_of_range("Invalid floor number");
+  }
+
+  elevator->set_floors_passed(
+      elevator->floors_passed() +
+      std::abs(static_cast<int>(elevator->target_floor() -
+                                elevator->current_floor())));
+
+  elevator->set_state(ElevatorState::IdleOpen, m_time);
+  elevator->pressed_buttons().reset(floor);
+
+  elevator->set_current_floor(floor);
+  elevator->set_target_floor(floor);
+
+  int floors_moved = abs(static_cast<int>(floor) -
+                         static_cast<int>(elevator->current_floor()));
+  elevator->set_floors_passed(elevator->floors_passed() + floors_moved);
+
+  information_with_guard([&] {
+    return "[" + std::to_string(m_time) + "] Elevator #" +
+           std::to_string(elevator->id()) + " arrived at floor " +
+           std::to_string(floor);
+  });
+
+  process_passengers_deboarding(floor, elevator, tally);
+
+  move_passengers_from_floor_to_elevator(floor, elevator, tally);
+  // Stops where nobody got on or off are skipped; tick and event modes see
+  // different numbers of those.
+  if (tally.boarded > 0 || tally.delivered.delivered > 0) {
+    double const percent =
+        100 * elevator->current_load() / elevator->max_load();
+    m_load_histograms[elevator - m_elevators.data()].record(
+        static_cast<size_t>(std::lround(percent)));
+    if (m_trace != nullptr) {
+      m_trace->cabin_load(*elevator, m_time);
+    }
+  }
+  elevator->set_state(ElevatorState::IdleClosed, m_time);
+
+  calculate_next_elevator_target(floor, elevator);
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::process_passengers_deboarding(
+    size_t floor, Elevator *elevator, ArrivalTally &tally) {
+  if (elevator == nullptr) {
+    throw std::runtime_error("nullptr passenenger deboarding");
+  }
+  PROFILE_PHASE(timer, Phase::Deboarding);
+  auto &passengers = elevator->passengers();
+  auto it = passengers.begin();
+  while (it != passengers.end()) {
+    Passenger *next_passenger = *it;
+    if (next_passenger->target_floor() == floor) {
+      PROFILE_ITEMS(timer, 1);
+      PassengerDetails &details = m_passengers.details(*next_passenger);
+      details.deboarding_time = m_time;
+      count_delivery(*next_passenger, details, tally);
+      m_rides.record_deboarding(details.ride_elevator, details.ride, m_time);
+      elevator->move_passenger_out(it);  // updates iterator
+      if (m_trace != nullptr) {
+        m_trace->passenger_deboarded(*elevator, details.id, floor, m_time);
+      }
+      information_with_guard([&] {
+        return "[" + std::to_string(m_time) + "] Passenger #" +
+               std::to_string(details.id) + " arrived at floor " +
+               std::to_string(floor) + " via elevator #" +
+               std::to_string(elevator->id());
+      });
+      if (m_streaming) {
+        retire_passenger(*next_passenger);
+      }
+    } else {
+      Elevator *max_weight_elevator = nullptr;
+      double max_weight = 0;
+      for (auto &e : m_elevators) {
+        if (e.max_load() > max_weight) {
+          max_weight = e.max_load();
+          max_weight_elevator = &e;
+        }
+      }
+      ++it;
+    }
+  }
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::move_passengers_from_floor_to_elevator(
+    size_t floor, Elevator *elevator, ArrivalTally &tally) {
+  if (elevator == nullptr) {
+    throw std::runtime_error("nullptr move_passengers_from_floor_to_elevator");
+  }
+  PROFILE_PHASE(timer, Phase::Boarding);
+  auto &waiting_queue = m_waiting_passengers_by_floor.at(floor);
+
+  auto it = waiting_queue.begin();
+  size_t const boarded = tally.boarded;
+
+  while (it != waiting_queue.end()) {
+    Passenger *next_passenger = *it;
+    PassengerDetails &details = m_passengers.details(*next_passenger);
+    if (elevator->try_move_passenger_in(next_passenger)) {
+      PROFILE_ITEMS(timer, 1);
+      ++tally.boarded;
+      tally.boarded_appear_sum += next_passenger->appear_time();
+      tally.boarded_wait += m_time - next_passenger->appear_time();
+      details.ride_elevator = static_cast<std::uint32_t>(elevator->id());
+      details.ride =
+          m_rides.record_boarding(elevator->id(), details.id, m_time,
+                                  elevator->passengers().size() - 1);
+      it = waiting_queue.erase(it);
+      elevator->pressed_buttons().set(next_passenger->target_floor());
+      if (m_trace != nullptr) {
+        m_trace->passenger_boarded(*elevator, details.id, floor, m_time);
+      }
+      information_with_guard([&] {
+        return "[" + std::to_string(m_time) + "] Passenger #" +
+               std::to_string(details.id) + " entered elevator on floor " +
+               std::to_string(floor);
+      });
+    } else {
+      details.had_overload = true;
+      ++it;
+    }
+  }
+  if (m_trace != nullptr && boarded != tally.boarded) {
+    m_trace->floor_queue(floor, waiting_queue.size(), m_time);
+  }
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::calculate_next_elevator_target(
+    size_t floor, Elevator *elevator) const {
+  if (elevator == nullptr) {
+    throw std::runtime_error("nullptr calculate_next_elevator_target");
+  }
+  NextStop const next = m_policy.next_stop(*elevator, floor);
+
+  if (next.state != ElevatorState::IdleClosed) {
+    bool const was_moving_down = elevator->state() == ElevatorState::MovingDown;
+    bool const up = next.state == ElevatorState::MovingUp;
+    elevator->set_state(next.state, m_time);
+    elevator->set_target_floor(next.floor);
+    elevator->calculate_moving_time(m_time);
+    information_with_guard([&] {
+      // Arrivals planned on the way down have always been logged offset by
+      // the current time.
+      size_t const arrival =
+          elevator->time_travel_ends() + (was_moving_down ? m_time : 0);
+      return "[" + std::to_string(m_time) + "] Elevator #" +
+             std::to_string(elevator->id()) +
+             (up != was_moving_down ? " continues "
+                                    : " changes direction to ") +
+             (up ? "MovingUp" : "MovingDown") + " - next target floor " +
+             std::to_string(next.floor) + ", will arrive at [" +
+             std::to_string(arrival) + "]";
+    });
+
+    return;
+  }
+
+  information_with_guard([&] {
+    return "[" + std::to_string(m_time) + "] Elevator #" +
+           std::to_string(elevator->id()) +
+           " started idleing (no buttons pressed)";
+  });
+  elevator->set_state(ElevatorState::IdleClosed, m_time);
+  // elevator->set_target_floor(0);
+}
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::arrive_passengers(size_t current_time) {
+  PROFILE_PHASE(timer, Phase::ArrivePassengers);
+  while (has_pending_arrival() && next_arrival_time() <= current_time) {
+    Passenger *p = take_next_arrival();
+    if (p == nullptr) {
+      continue;
+    }
+    PROFILE_ITEMS(timer, 1);
+    auto &waiting_queue = m_waiting_passengers_by_floor.at(p->boarding_floor());
+    waiting_queue.push_back(p);
+    if (m_trace != nullptr) {
+      m_trace->floor_queue(p->boarding_floor(), waiting_queue.size(), m_time);
+    }
+    ++m_waiting;
+    m_waiting_appear_sum += p->appear_time();
+    refresh_hall_call(p->boarding_floor());
+    test_passengers_appeared_on_starting_floors++;
+    information_with_guard([&] {
+      return "[" + std::to_string(m_time) + "] Passenger #" +
+             std::to_string(m_passengers.details(*p).id) +
+             " waiting elevator at floor " +
+             std::to_string(p->boarding_floor()) + ", Target floor: " +
+             std::to_string(p->target_floor());
+    });
+  }
+}
+
+template <DispatchPolicy Policy>
+Elevator *ElevatorSystem<Policy>::calculate_most_suitable_elevator(
+    size_t floor) {
+  size_t const index = m_policy.assign(floor, m_time);
+  if (index == FleetState::npos) {
+    information_with_guard(
+        [] { return "No suitable elevator found for interrupt"; });
+    return nullptr;
+  }
+
+  return &m_elevators[index];
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::interrupt_elevator(Elevator *elevator,
+                                                size_t target_floor) const {
+  if (elevator == nullptr) {
+    throw std::runtime_error("nullptr interrupt_elevator");
+  }
+  if (target_floor == 0) {
+    throw std::runtime_error("target floor can not be 0");
+  };
+
+  elevator->pressed_buttons().set(target_floor);
+
+  size_t current_approx_floor = m_policy.interrupt_floor(*elevator, m_time);
+  elevator->set_current_floor(current_approx_floor);
+  calculate_next_elevator_target(current_approx_floor, elevator);
+
+  // ElevatorState
+  // new_state = current_approx_floor < target_floor
+  //                               ? ElevatorState::MovingUp
+  //                               : ElevatorState::MovingDown;
+  //
+  // elevator->set_target_floor(target_floor);
+  // elevator->set_state(new_state, m_time);
+  // elevator->calculate_moving_time_with_interrupt(m_time, target_floor);
+  //
+  // information_with_guard(
+  //     "[" + std::to_string(m_time) + "] Elevator #" +
+  //     std::to_string(elevator->id()) + " interrupted to floor " +
+  //     std::to_string(target_floor) + " (approximate current floor: " +
+  //     std::to_string(current_approx_floor) + "), will arrive at [" +
+  //     std::to_string(elevator->time_travel_ends()) + "]");
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::save_floors(CheckpointWriter &out,
+                                         FloorBitset const &floors) {
+  std::vector<std::uint32_t> members;
+  for (size_t floor = floors.find_next(0); floor != FloorBitset::npos;
+       floor = floors.find_next(floor + 1)) {
+    members.push_back(static_cast<std::uint32_t>(floor));
+  }
+  out.put_vector<std::uint32_t>(members);
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::restore_floors(CheckpointReader &in,
+                                            FloorBitset &floors) {
+  floors = FloorBitset(floors.size());
+  for (std::uint32_t floor : in.get_vector<std::uint32_t>()) {
+    floors.set(floor);
+  }
+}
+
+// Configuration (mode, limits, threads, logger) is not part of the state;
+// the restoring system keeps its own. Passengers are saved column by column
+// in slot order, which add() reproduces on restore.
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::save_state(CheckpointWriter &out) const {
+  out.put<std::uint64_t>(m_floors_count);
+  out.put<std::uint64_t>(m_elevators.size());
+  out.put<std::uint64_t>(m_time);
+
+  size_t const slots = m_passengers.slots();
+  std::vector<std::uint64_t> ids(slots), appear_times(slots),
+      boarding_times(slots), deboarding_times(slots), rides(slots);
+  std::vector<std::uint32_t> boarding_floors(slots), target_floors(slots),
+      ride_elevators(slots);
+  std::vector<double> weights(slots);
+  std::vector<std::uint8_t> overloads(slots);
+  for (size_t slot = 0; slot < slots; ++slot) {
+    Passenger const &passenger =
+        m_passengers.at(static_cast<std::uint32_t>(slot));
+    PassengerDetails const &details = m_passengers.details(passenger);
+    ids[slot] = details.id;
+    appear_times[slot] = passenger.appear_time();
+    boarding_floors[slot] =
+        static_cast<std::uint32_t>(passenger.boarding_floor());
+    target_floors[slot] = static_cast<std::uint32_t>(passenger.target_floor());
+    weights[slot] = passenger.weight();
+    boarding_times[slot] = details.boarding_time;
+    deboarding_times[slot] = details.deboarding_time;
+    rides[slot] = details.ride;
+    ride_elevators[slot] = details.ride_elevator;
+    overloads[slot] = details.had_overload;
+  }
+  out.put_vector<std::uint64_t>(ids);
+  out.put_vector<std::uint64_t>(appear_times);
+  out.put_vector<std::uint32_t>(boarding_floors);
+  out.put_vector<std::uint32_t>(target_floors);
+  out.put_vector<double>(weights);
+  out.put_vector<std::uint64_t>(boarding_times);
+  out.put_vector<std::uint64_t>(deboarding_times);
+  out.put_vector<std::uint64_t>(rides);
+  out.put_vector<std::uint32_t>(ride_elevators);
+  out.put_vector<std::uint8_t>(overloads);
+  out.put(m_next_arrival);
+
+  for (auto const &queue : m_waiting_passengers_by_floor) {
+    std::vector<std::uint32_t> waiting;
+    waiting.reserve(queue.size());
+    for (Passenger const *passenger : queue) {
+      waiting.push_back(passenger->slot());
+    }
+    out.put_vector<std::uint32_t>(waiting);
+  }
+  save_floors(out, m_unassigned_hall_calls);
+  save_floors(out, m_floors_already_called_elevator);
+
+  for (auto const &elevator : m_elevators) {
+    out.put<std::uint64_t>(elevator.id());
+    elevator.save(out);
+  }
+  m_rides.save(out);
+
+  out.put(m_remaining_passengers);
+  out.put(test_passengers_appeared_on_starting_floors);
+  out.put(test_pasengers_succesfully_moved_to_dest);
+  out.put<std::uint64_t>(m_totals.delivered);
+  out.put<std::uint64_t>(m_totals.total_wait);
+  out.put<std::uint64_t>(m_totals.max_wait);
+  out.put<std::uint64_t>(m_totals.total_travel);
+  out.put<std::uint64_t>(m_totals.max_travel);
+  m_wait_histogram.save(out);
+  m_cabin_histogram.save(out);
+  for (Histogram const &histogram : m_load_histograms) {
+    histogram.save(out);
+  }
+  out.put<std::uint64_t>(m_passenger_count);
+  out.put<std::uint64_t>(m_boarded_wait);
+  out.put<std::uint64_t>(m_waiting);
+  out.put<std::uint64_t>(m_waiting_appear_sum);
+  out.put(m_stopped_early);
+
+  std::vector<std::uint64_t> times;
+  for (auto queue = m_event_times; !queue.empty(); queue.pop()) {
+    times.push_back(queue.top());
+  }
+  out.put_vector<std::uint64_t>(times);
+  std::vector<std::uint64_t> const scheduled(m_scheduled_arrivals.begin(),
+                                             m_scheduled_arrivals.end());
+  out.put_vector<std::uint64_t>(scheduled);
+  out.put<std::uint64_t>(m_scheduled_appearance);
+}
+
+template <DispatchPolicy Policy>
+void ElevatorSystem<Policy>::restore_state(CheckpointReader &in) {
+  if (in.get<std::uint64_t>() != m_floors_count ||
+      in.get<std::uint64_t>() != m_elevators.size()) {
+    throw std::runtime_error(
+        "Checkpoint was written for a different building or fleet size");
+  }
+  m_time = in.get<std::uint64_t>();
+
+  auto const ids = in.get_vector<std::uint64_t>();
+  auto const appear_times = in.get_vector<std::uint64_t>();
+  auto const boarding_floors = in.get_vector<std::uint32_t>();
+  auto const target_floors = in.get_vector<std::uint32_t>();
+  auto const weights = in.get_vector<double>();
+  auto const boarding_times = in.get_vector<std::uint64_t>();
+  auto const deboarding_times = in.get_vector<std::uint64_t>();
+  auto const rides = in.get_vector<std::uint64_t>();
+  auto const ride_elevators = in.get_vector<std::uint32_t>();
+  auto const overloads = in.get_vector<std::uint8_t>();
+  size_t const slots = ids.size();
+  for (size_t column : {appear_times.size(), boarding_floors.size(),
+                        target_floors.size(), weights.size(),
+                        boarding_times.size(), deboarding_times.size(),
+                        rides.size(), ride_elevators.size(),
+                        overloads.size()}) {
+    if (column != slots) {
+      throw std::runtime_error("Checkpoint passenger columns disagree");
+    }
+  }
+
+  m_passengers.release_id_index();
+  for (size_t slot = 0; slot < slots; ++slot) {
+    Passenger *passenger =
+        m_passengers.add(ids[slot], appear_times[slot], boarding_floors[slot],
+                         target_floors[slot], weights[slot]);
+    PassengerDetails &details = m_passengers.details(*passenger);
+    details.boarding_time = boarding_times[slot];
+    details.deboarding_time = deboarding_times[slot];
+    details.ride = rides[slot];
+    details.ride_elevator = ride_elevators[slot];
+    details.had_overload = overloads[slot] != 0;
+  }
+  m_next_arrival = in.get<std::uint32_t>();
+
+  for (auto &queue : m_waiting_passengers_by_floor) {
+    queue.clear();
+    for (std::uint32_t slot : in.get_vector<std::uint32_t>()) {
+      queue.push_back(&m_passengers.at(slot));
+    }
+  }
+  restore_floors(in, m_unassigned_hall_calls);
+  restore_floors(in, m_floors_already_called_elevator);
+
+  for (auto &elevator : m_elevators) {
+    if (in.get<std::uint64_t>() != elevator.id()) {
+      throw std::runtime_error("Checkpoint was written for other elevators");
+    }
+    elevator.restore(in, m_passengers);
+    refresh_elevator(elevator);
+  }
+  m_rides.restore(in);
+
+  m_remaining_passengers = in.get<int>();
+  test_passengers_appeared_on_starting_floors = in.get<int>();
+  test_pasengers_succesfully_moved_to_dest = in.get<int>();
+  m_totals.delivered = in.get<std::uint64_t>();
+  m_totals.total_wait = in.get<std::uint64_t>();
+  m_totals.max_wait = in.get<std::uint64_t>();
+  m_totals.total_travel = in.get<std::uint64_t>();
+  m_totals.max_travel = in.get<std::uint64_t>();
+  m_wait_histogram.restore(in);
+  m_cabin_histogram.restore(in);
+  for (Histogram &histogram : m_load_histograms) {
+    histogram.restore(in);
+  }
+  m_passenger_count = in.get<std::uint64_t>();
+  m_boarded_wait = in.get<std::uint64_t>();
+  m_waiting = in.get<std::uint64_t>();
+  m_waiting_appear_sum = in.get<std::uint64_t>();
+  m_stopped_early = in.get<bool>();
+
+  m_event_times = {};
+  for (std::uint64_t time : in.get_vector<std::uint64_t>()) {
+    m_event_times.push(time);
+  }
+  auto const scheduled = in.get_vector<std::uint64_t>();
+  m_scheduled_arrivals.assign(scheduled.begin(), scheduled.end());
+  m_scheduled_appearance = in.get<std::uint64_t>();
+
+  if (in.remaining() != 0) {
+    throw std::runtime_error("Unexpected data at the end of the checkpoint");
+  }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "elevator.h"
+
+// The fields dispatch reads, copied out of every Elevator into parallel
+// arrays so the approximate floor and the suitability of the whole fleet can
+// be evaluated a few lanes at a time. Elevator stays the owner of the state;
+// update() must be called after an elevator changes.
+//
+// All kernels give bit-identical results: the approximate floor is exactly
+// Elevator::elevator_aproximate_floor cast to int, as dispatch uses it.
+class FleetState final {
+ public:
+  enum class Kernel : std::uint8_t {
+    Scalar,
+    Avx2,
+  };
+
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  // Avx2 when the CPU has it, Scalar otherwise.
+  static Kernel best_kernel() noexcept;
+
+  explicit FleetState(std::vector<Elevator> const &elevators,
+                      Kernel kernel = best_kernel());
+
+  void update(size_t index, Elevator const &elevator);
+
+  size_t size() const noexcept { return m_size; }
+  Kernel kernel() const noexcept { return m_kernel; }
+  ElevatorState state(size_t index) const noexcept;
+  double max_load(size_t index) const noexcept { return m_max_load[index]; }
+
+  int approximate_floor(size_t index, size_t time) const noexcept;
+  std::span<int const> approximate_floors(size_t time);
+
+  // Tie-break between elevators at the same distance from a hall call:
+  // whether dispatch takes the candidate over the one chosen so far.
+  bool preferred(size_t candidate, size_t chosen) const noexcept;
+
+  bool has_suitable(size_t floor, size_t time);
+  // Same choice as ElevatorSystem's scan over Elevator objects; npos if no
+  // elevator is suitable.
+  size_t nearest_suitable(size_t floor, size_t time);
+
+ private:
+  // Arrays are padded to whole vectors; padding lanes hold this state and
+  // are never suitable.
+  static constexpr std::uint8_t padding_state = 0xFF;
+  static constexpr size_t lanes = 8;
+
+  Kernel m_kernel;
+  size_t m_size;
+  std::vector<std::uint8_t> m_state;
+  std::vector<std::uint32_t> m_current_floor;
+  std::vector<std::uint32_t> m_target_floor;
+  std::vector<std::uint64_t> m_state_time;
+  std::vector<std::uint64_t> m_travel_ends;
+  std::vector<double> m_max_load;
+
+  // approximate floors at m_approximate_time, kept current by update()
+  std::vector<int> m_approximate;
+  std::vector<int> m_distance;
+  std::vector<std::uint32_t> m_ties;
+  size_t m_approximate_time = 0;
+  bool m_approximate_valid = false;
+};
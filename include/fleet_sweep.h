@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "elevator_system.h"
+#include "passenger_table.h"
+
+// One building to try: the floors and the max load of every car.
+struct FleetConfig {
+  size_t floors_count = 0;
+  std::vector<double> max_loads;
+
+  double total_capacity() const noexcept;
+};
+
+// Reads one configuration per line in the elevators file format,
+// "<floors> <elevators> <max load>...", where a single max load stands for
+// all cars of the line. '#' starts a comment.
+std::vector<FleetConfig> parse_fleet_grid(std::string const &file);
+
+struct SweepResult {
+  FleetConfig config;
+  PassengerTotals totals;
+  size_t end_time = 0;
+  double seconds = 0;
+  bool stopped_early = false;  // sure to miss the wait target
+  std::string error;           // why modeling failed; empty when it did not
+
+  double mean_wait() const noexcept;
+  double mean_travel() const noexcept;
+};
+
+// Models one passenger table against many fleets concurrently. The table is
+// shared read-only by all runs, so the trace is parsed once whatever the
+// number of configurations.
+class FleetSweep final {
+ public:
+  FleetSweep(std::shared_ptr<PassengerTable const> passengers,
+             std::vector<FleetConfig> configs);
+
+  // One of the built-in dispatch policies by name; NearestSuitableDispatch
+  // unless set.
+  FleetSweep &set_policy(std::string const &name);
+  // 0, the default, uses every hardware thread.
+  FleetSweep &set_threads(size_t threads) noexcept;
+  FleetSweep &set_mode(SimulationMode mode) noexcept;
+  FleetSweep &set_time_limit(size_t limit) noexcept;
+  // Runs whose mean wait is sure to exceed this stop as soon as that shows.
+  FleetSweep &set_wait_target(double mean_wait) noexcept;
+
+  // Results in the order of the configurations.
+  std::vector<SweepResult> run() const;
+
+  // Finished runs by mean wait, then the smaller fleet and capacity; after
+  // them those stopped early, then the failed ones.
+  static std::vector<SweepResult> ranked(std::vector<SweepResult> results);
+
+ private:
+  std::shared_ptr<PassengerTable const> m_passengers;
+  std::vector<FleetConfig> m_configs;
+  size_t m_threads = 0;
+  SimulationMode m_mode = SimulationMode::Event;
+  size_t m_time_limit = std::numeric_limits<size_t>::max();
+  std::optional<double> m_wait_target;
+  SweepResult (FleetSweep::*m_run_config)(FleetConfig const &) const =
+      &FleetSweep::run_config<NearestSuitableDispatch>;
+
+  template <DispatchPolicy Policy>
+  SweepResult run_config(FleetConfig const &config) const;
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Word-packed set of floor numbers. Walking the members costs one
+// countr_zero per member plus one load per 64 floors, so sparse sets over
+// tall buildings are cheap to scan. Like std::vector::at, single-floor
+// access throws for floors outside the building.
+class FloorBitset final {
+ public:
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  FloorBitset() = default;
+  explicit FloorBitset(size_t floors)
+      : m_words((floors + word_bits - 1) / word_bits), m_floors(floors) {}
+
+  size_t size() const noexcept { return m_floors; }
+
+  bool test(size_t floor) const {
+    check(floor);
+    return (m_words[floor / word_bits] >> (floor % word_bits)) & 1U;
+  }
+  void set(size_t floor) {
+    check(floor);
+    m_words[floor / word_bits] |= bit(floor);
+  }
+  void reset(size_t floor) {
+    check(floor);
+    m_words[floor / word_bits] &= ~bit(floor);
+  }
+  void assign(size_t floor, bool value) { value ? set(floor) : reset(floor); }
+
+  bool any() const noexcept {
+    for (std::uint64_t word : m_words) {
+      if (word != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+  bool none() const noexcept { return !any(); }
+
+  // First member not below floor, or npos.
+  size_t find_next(size_t floor) const noexcept {
+    if (floor >= m_floors) {
+      return npos;
+    }
+
+    size_t index = floor / word_bits;
+    std::uint64_t word =
+        m_words[index] & (~std::uint64_t{0} << (floor % word_bits));
+    while (word == 0) {
+      if (++index == m_words.size()) {
+        return npos;
+      }
+      word = m_words[index];
+    }
+
+    return (index * word_bits) + std::countr_zero(word);
+  }
+
+  // Last member not above floor, or npos. npos itself (as left by
+  // "floor - 1" at floor 0) finds nothing; other floors must exist.
+  size_t find_prev(size_t floor) const {
+    if (floor == npos) {
+      return npos;
+    }
+    check(floor);
+
+    size_t index = floor / word_bits;
+    std::uint64_t word =
+        m_words[index] &
+        (~std::uint64_t{0} >> (word_bits - 1 - (floor % word_bits)));
+    while (word == 0) {
+      if (index-- == 0) {
+        return npos;
+      }
+      word = m_words[index];
+    }
+
+    return (index * word_bits) + (word_bits - 1) - std::countl_zero(word);
+  }
+
+ private:
+  static constexpr size_t word_bits = 64;
+
+  std::vector<std::uint64_t> m_words;
+  size_t m_floors = 0;
+
+  static std::uint64_t bit(size_t floor) noexcept {
+    return std::uint64_t{1} << (floor % word_bits);
+  }
+
+  void check(size_t floor) const {
+    if (floor >= m_floors) {
+      throw std::out_of_range("Invalid floor number " + std::to_string(floor) +
+                              " (bitset of " + std::to_string(m_floors) +
+                              " floors)");
+    }
+  }
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+class CheckpointWriter;
+class CheckpointReader;
+
+// Counts of non-negative integers in log-linear buckets, the way HDR
+// histograms keep them: exact below 2 * sub_buckets, and above that within
+// 1 / sub_buckets of the value, over the whole range of size_t. The buckets
+// grow with the largest value recorded and never past 30 KiB, so memory does
+// not depend on how many values go in.
+class Histogram final {
+ public:
+  static constexpr size_t sub_buckets = 64;
+
+  void record(size_t value);
+  void merge(Histogram const &other);
+
+  size_t count() const noexcept { return m_count; }
+  size_t min() const noexcept { return m_count == 0 ? 0 : m_min; }
+  size_t max() const noexcept { return m_max; }
+  double mean() const noexcept;
+  // Highest value counted alike with the one below which percent of the
+  // values lie, clamped to max(); 0 when empty.
+  size_t percentile(double percent) const noexcept;
+
+  void save(CheckpointWriter &out) const;
+  void restore(CheckpointReader &in);
+
+ private:
+  std::vector<std::uint64_t> m_counts;
+  size_t m_count = 0;
+  size_t m_min = std::numeric_limits<size_t>::max();
+  size_t m_max = 0;
+  size_t m_sum = 0;
+
+  static size_t bucket_of(size_t value) noexcept;
+  static size_t highest_in(size_t bucket) noexcept;
+};
@@ -0,0 +1,51 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_FORMAT_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_FORMAT_H
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "logger.h"
+
+// Log format compiled once into a token list, so rendering a record is a
+// single pass of appends instead of a find/replace pass per placeholder.
+class log_format final {
+
+public:
+  enum class token_kind : std::uint8_t {
+    literal,
+    date,     // %d
+    time,     // %t
+    severity, // %s
+    message   // %m
+  };
+
+  struct token {
+    token_kind kind;
+    std::string literal;
+  };
+
+private:
+  std::vector<token> _tokens;
+  size_t _literal_length = 0;
+  bool _uses_clock = false;
+
+public:
+  log_format();
+
+  explicit log_format(std::string const &format);
+
+public:
+  void render(std::string &buffer, std::string const &message,
+              logger::severity severity, time_t current_date_time) const;
+
+  size_t estimated_length(std::string const &message) const noexcept;
+
+  bool uses_clock() const noexcept;
+
+private:
+  static std::string const &severity_text(logger::severity severity);
+};
+
+#endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_FORMAT_H
@@ -0,0 +1,77 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_STREAM_REGISTRY_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_STREAM_REGISTRY_H
+
+#include <array>
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "mapped_log_file.h"
+
+// One stream opened for a path and shared by every client_logger writing
+// there. Text is appended in one piece under its lock, so whole lines from
+// different threads and loggers never interleave.
+class shared_log_stream final {
+
+  friend class log_stream_registry;
+
+private:
+  std::mutex _mutex;
+  std::unique_ptr<std::ofstream> _file;
+  std::unique_ptr<mapped_log_file> _mapped_file;
+  std::ostream *_stream = nullptr;
+  size_t _references = 0; // guarded by the registry shard
+
+public:
+  // An empty path is the console, which is never mapped.
+  shared_log_stream(
+      std::string const &path,
+      std::optional<mapped_log_file::settings> const &mapped_settings);
+
+  ~shared_log_stream();
+
+  shared_log_stream(shared_log_stream const &) = delete;
+  shared_log_stream &operator=(shared_log_stream const &) = delete;
+
+public:
+  void write(std::string_view lines, bool flush);
+
+  // Mapped files need no flushing; their pages are the file's.
+  void flush();
+};
+
+// Process-wide table of the open log streams by path, reference counted by
+// the loggers using them. Paths are spread over shards with a lock each, so
+// loggers opening and closing different files do not contend.
+class log_stream_registry final {
+
+public:
+  static constexpr size_t shards_count = 16;
+
+private:
+  struct alignas(64) shard {
+    std::mutex mutex;
+    std::map<std::string, std::unique_ptr<shared_log_stream>> streams;
+  };
+
+public:
+  // Opens the stream on first use, mapped if settings are given; a path
+  // already open stays as it was opened. Balance each call with release().
+  static shared_log_stream *
+  acquire(std::string const &path,
+          std::optional<mapped_log_file::settings> const &mapped_settings);
+
+  // Flushes and closes the stream once its last user releases it.
+  static void release(std::string const &path);
+
+private:
+  static shard &shard_of(std::string const &path);
+};
+
+#endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_STREAM_REGISTRY_H
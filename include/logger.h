@@ -3,9 +3,21 @@
 
 #include <iostream>
 
+// Records below this severity are compiled out of the lazy logging helpers
+// (see logger_guardant). 0 = trace ... 5 = critical.
+#ifndef LOGGER_MIN_SEVERITY
+#ifdef DEBUG
+#define LOGGER_MIN_SEVERITY 0
+#else
+#define LOGGER_MIN_SEVERITY 2
+#endif
+#endif
+
 class logger
 {
 
+    friend class log_format;
+
 public:
 
     enum class severity
@@ -18,6 +30,9 @@ public:
         critical
     };
 
+    static constexpr severity compile_time_min_severity =
+        static_cast<severity>(LOGGER_MIN_SEVERITY);
+
 public:
 
     virtual ~logger() noexcept = default;
@@ -28,6 +43,9 @@ public:
         std::string const &message,
         logger::severity severity) const noexcept = 0;
 
+    virtual bool is_enabled(
+        logger::severity severity) const noexcept;
+
 public:
 
     logger const *trace(
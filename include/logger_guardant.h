@@ -1,7 +1,11 @@
 #ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOGGER_GUARDANT_H
 #define MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOGGER_GUARDANT_H
 
+#include <concepts>
+#include <string>
+
 #include "logger.h"
+#include "phase_profiler.h"
 
 class logger_guardant
 {
@@ -34,6 +38,70 @@ public:
     logger_guardant const *critical_with_guard(
         std::string const &message) const;
 
+public:
+
+    // Lazy variants: the message factory runs only if a stream is attached
+    // at that severity, and call sites below LOGGER_MIN_SEVERITY compile
+    // away entirely.
+    template <logger::severity severity, std::invocable message_factory>
+    logger_guardant const *log_with_guard(
+        message_factory &&make_message) const
+    {
+        if constexpr (severity >= logger::compile_time_min_severity)
+        {
+            logger *got_logger = get_logger();
+            if (got_logger != nullptr && got_logger->is_enabled(severity))
+            {
+                PROFILE_PHASE(timer, Phase::Logging);
+                got_logger->log(std::string(make_message()), severity);
+            }
+        }
+
+        return this;
+    }
+
+    template <std::invocable message_factory>
+    logger_guardant const *trace_with_guard(
+        message_factory &&make_message) const
+    {
+        return log_with_guard<logger::severity::trace>(make_message);
+    }
+
+    template <std::invocable message_factory>
+    logger_guardant const *debug_with_guard(
+        message_factory &&make_message) const
+    {
+        return log_with_guard<logger::severity::debug>(make_message);
+    }
+
+    template <std::invocable message_factory>
+    logger_guardant const *information_with_guard(
+        message_factory &&make_message) const
+    {
+        return log_with_guard<logger::severity::information>(make_message);
+    }
+
+    template <std::invocable message_factory>
+    logger_guardant const *warning_with_guard(
+        message_factory &&make_message) const
+    {
+        return log_with_guard<logger::severity::warning>(make_message);
+    }
+
+    template <std::invocable message_factory>
+    logger_guardant const *error_with_guard(
+        message_factory &&make_message) const
+    {
+        return log_with_guard<logger::severity::error>(make_message);
+    }
+
+    template <std::invocable message_factory>
+    logger_guardant const *critical_with_guard(
+        message_factory &&make_message) const
+    {
+        return log_with_guard<logger::severity::critical>(make_message);
+    }
+
 protected:
 
     inline virtual logger *get_logger() const = 0;
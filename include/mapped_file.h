@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only memory mapping of a whole file.
+class MappedFile final {
+ public:
+  explicit MappedFile(std::string const &path);
+  ~MappedFile();
+
+  MappedFile(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  char const *data() const noexcept { return m_data; }
+  size_t size() const noexcept { return m_size; }
+  std::string_view view() const noexcept { return {m_data, m_size}; }
+
+  // Drops the resident pages that lie entirely before offset. The data stays
+  // readable; it is paged in again if touched.
+  void discard_before(size_t offset) noexcept;
+
+ private:
+  char const *m_data = nullptr;
+  size_t m_size = 0;
+
+  void release() noexcept;
+};
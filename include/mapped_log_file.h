@@ -0,0 +1,53 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_MAPPED_LOG_FILE_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_MAPPED_LOG_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Log file written by memcpy into a mapped segment of fixed size, allocated
+// up front. A full segment is trimmed to what was written and renamed:
+// <path> is always the one being written, <path>.1 the one before it, and
+// so on up to <path>.<max_segments - 1>; older ones are deleted, so the log
+// never takes more than max_segments * segment_size bytes. A segment left
+// by a crash keeps its zero tail.
+class mapped_log_file final {
+
+public:
+  struct settings {
+    size_t segment_size = size_t{64} << 20; // rounded up to whole pages
+    size_t max_segments = 8;
+  };
+
+private:
+  std::string const _path;
+  settings const _settings;
+  int _fd = -1;
+  char *_data = nullptr;
+  size_t _used = 0;
+
+public:
+  // Throws if the first segment can not be created.
+  mapped_log_file(std::string path, settings const &file_settings);
+
+  ~mapped_log_file() noexcept;
+
+  mapped_log_file(mapped_log_file const &) = delete;
+  mapped_log_file &operator=(mapped_log_file const &) = delete;
+
+public:
+  // Starts a new segment rather than split a line, unless the line is
+  // longer than a whole segment. Once a segment can not be created, the
+  // rest is dropped, as a failed stream would.
+  void write(std::string_view lines) noexcept;
+
+  static void validate(settings const &file_settings);
+
+private:
+  bool open_segment() noexcept;
+  void close_segment() noexcept;
+  void rotate() noexcept;
+  std::string segment_path(size_t index) const;
+};
+
+#endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_MAPPED_LOG_FILE_H
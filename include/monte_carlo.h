@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "dispatch_policy.h"
+#include "elevator.h"
+#include "elevator_system.h"
+#include "traffic_generator.h"
+
+// One simulated day of a Monte Carlo run.
+struct ScenarioResult {
+  std::uint64_t seed = 0;
+  size_t passengers = 0;
+  size_t end_time = 0;
+  PassengerTotals totals;
+  std::string error;  // why modeling failed; empty when it did not
+};
+
+// Scenarios folded together in the order of their seeds. Means are over
+// the scenarios that finished; failed ones only count in failed.
+struct MonteCarloSummary {
+  size_t scenarios = 0;
+  size_t failed = 0;
+  size_t passengers = 0;
+  size_t delivered = 0;
+  double mean_wait = 0;
+  size_t max_wait = 0;
+  double mean_travel = 0;
+  size_t max_travel = 0;
+  double mean_end_time = 0;
+  size_t max_end_time = 0;
+
+  static MonteCarloSummary of(std::vector<ScenarioResult> const &results);
+};
+
+// Runs independent ElevatorSystem instances over seeded synthetic traffic
+// on a pool of threads. Scenario i always gets scenario_seed(seed, i) and
+// its result lands in slot i, so results do not depend on the thread count.
+// Nothing is logged.
+class MonteCarloRunner final {
+ public:
+  MonteCarloRunner(std::vector<Elevator> elevators, size_t floors_count,
+                   TrafficProfile profile);
+
+  // One of the built-in dispatch policies by name; NearestSuitableDispatch,
+  // the ElevatorSystem default, unless set.
+  MonteCarloRunner &set_policy(std::string const &name);
+  // 0, the default, uses every hardware thread.
+  MonteCarloRunner &set_threads(size_t threads) noexcept;
+  MonteCarloRunner &set_mode(SimulationMode mode) noexcept;
+  // Scenarios still running at this time are reported as failed.
+  MonteCarloRunner &set_time_limit(size_t limit) noexcept;
+
+  std::vector<ScenarioResult> run(std::uint64_t seed, size_t scenarios) const;
+
+ private:
+  std::vector<Elevator> m_elevators;
+  size_t m_floors_count;
+  TrafficGenerator m_traffic;
+  size_t m_threads = 0;
+  SimulationMode m_mode = SimulationMode::Event;
+  size_t m_time_limit = std::numeric_limits<size_t>::max();
+  ScenarioResult (MonteCarloRunner::*m_run_scenario)(std::uint64_t) const =
+      &MonteCarloRunner::run_scenario<NearestSuitableDispatch>;
+
+  template <DispatchPolicy Policy>
+  ScenarioResult run_scenario(std::uint64_t seed) const;
+};
@@ -1,50 +1,45 @@
 #pragma once
 
 #include <cstddef>
-#include <set>
+#include <cstdint>
 
+#include "ride_log.h"
+
+// What dispatching, boarding and deboarding read about a passenger, kept
+// small so the cabins and waiting queues stay cheap to walk. Reporting data
+// lives apart in PassengerDetails; both are owned by PassengerStore.
 class Passenger final {
  private:
-  size_t m_id;
-  size_t m_appear_time;
-  size_t m_boarding_floor;
-  size_t m_target_floor;
-  double m_weight;
-  size_t m_boarding_time = 0;
-  size_t m_deboarding_time = 0;
-
-  bool m_has_overload_lift = false;
-  std::set<Passenger*> m_met_passengers;
+  size_t m_appear_time = 0;
+  double m_weight = 0;
+  std::uint32_t m_boarding_floor = 0;
+  std::uint32_t m_target_floor = 0;
+  std::uint32_t m_slot = 0;
 
  public:
-  Passenger(size_t id, size_t appear_time, size_t boarding_floor,
+  Passenger() = default;
+  Passenger(std::uint32_t slot, size_t appear_time, size_t boarding_floor,
             size_t target_floor, double weight)
-      : m_id(id),
-        m_appear_time(appear_time),
-        m_boarding_floor(boarding_floor),
-        m_target_floor(target_floor),
-        m_weight(weight) {}
+      : m_appear_time(appear_time),
+        m_weight(weight),
+        m_boarding_floor(static_cast<std::uint32_t>(boarding_floor)),
+        m_target_floor(static_cast<std::uint32_t>(target_floor)),
+        m_slot(slot) {}
 
-  size_t id() const noexcept { return m_id; }
   size_t appear_time() const noexcept { return m_appear_time; }
   size_t boarding_floor() const noexcept { return m_boarding_floor; }
   size_t target_floor() const noexcept { return m_target_floor; }
   double weight() const noexcept { return m_weight; }
-  bool has_overload_lift() const noexcept { return m_has_overload_lift; }
-  void add_met_passenger(Passenger* passenger) {
-    m_met_passengers.insert(passenger);
-  }
-  void set_deboarding_time(size_t time) { m_deboarding_time = time; }
-
-  void set_overload_lift() { m_has_overload_lift = true; }
-  size_t boarding_time() const { return m_boarding_time; }
-  size_t deboarding_time() const { return m_deboarding_time; }
-
-  bool has_met_passenger(Passenger* const passenger) const {
-    return m_met_passengers.contains(passenger);
-  }
+  std::uint32_t slot() const noexcept { return m_slot; }
+};
 
-  const std::set<Passenger*>& met_passengers() const {
-    return m_met_passengers;
-  }
+// Cold half of a passenger: written on boarding and deboarding, read when
+// the results are printed.
+struct PassengerDetails {
+  size_t id = 0;
+  size_t boarding_time = 0;
+  size_t deboarding_time = 0;
+  size_t ride = RideLog::npos;
+  std::uint32_t ride_elevator = 0;
+  bool had_overload = false;
 };
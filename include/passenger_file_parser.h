@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "mapped_file.h"
+
+struct PassengerRecord {
+  size_t id = 0;
+  double weight = 0;
+  size_t boarding_floor = 0;
+  size_t appear_time = 0;
+  size_t target_floor = 0;
+  size_t line = 0;             // line of the record's first field
+  std::string_view time_text;  // "hh:mm" as written, points into the file
+};
+
+// Tokenizes a passengers file in place over a read-only mapping. Records are
+// whitespace separated "id weight floor hh:mm target_floor", as before.
+class PassengerFileParser final {
+ public:
+  explicit PassengerFileParser(std::string const &file);
+
+  // Returns false once the input is exhausted.
+  bool next(PassengerRecord &record);
+
+  size_t bytes_total() const noexcept { return m_file.size(); }
+  size_t bytes_consumed() const noexcept { return m_position; }
+
+  // Lets the pages under already parsed records leave memory.
+  void discard_before(size_t offset) noexcept { m_file.discard_before(offset); }
+
+  static size_t time_to_numerical(std::string_view time, size_t line);
+
+ private:
+  MappedFile m_file;
+  size_t m_position = 0;
+  size_t m_line = 1;
+
+  std::string_view next_token();
+  template <typename T>
+  T parse_field(std::string_view token, char const *field, size_t line) const;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#include "passenger_file_parser.h"
+#include "passenger_trace.h"
+
+// Hands out passenger records one at a time from either a text passengers
+// file or a binary trace, so a run can read its input just ahead of the
+// clock instead of loading it up front. Records must be sorted by appear
+// time; the source checks that as it goes.
+class PassengerSource final {
+ public:
+  explicit PassengerSource(std::string const &file);
+
+  // Returns false once the input is exhausted.
+  bool next(PassengerRecord &record);
+
+ private:
+  // Pages of the text file already parsed are dropped in steps of this size.
+  static constexpr size_t discard_step = size_t{4} << 20;
+
+  std::string m_file_name;
+  std::optional<PassengerFileParser> m_parser;
+  std::optional<PassengerTrace> m_trace;
+  size_t m_position = 0;
+  size_t m_discarded = 0;
+  size_t m_last_appear_time = 0;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "passenger.h"
+
+// Owns passengers in fixed-size chunks addressed by a dense slot number, so
+// the Passenger pointers handed to elevators and floors stay valid while the
+// store grows. Hot and cold halves sit in parallel chunks under the same
+// slot. Slots of removed passengers are reused.
+class PassengerStore final {
+ public:
+  static constexpr size_t chunk_size = 4096;
+
+  // Returns nullptr if a passenger with this id is already stored.
+  Passenger *add(size_t id, size_t appear_time, size_t boarding_floor,
+                 size_t target_floor, double weight);
+  void remove(Passenger const &passenger);
+
+  Passenger &at(std::uint32_t slot);
+  Passenger const &at(std::uint32_t slot) const;
+  PassengerDetails &details(Passenger const &passenger);
+  PassengerDetails const &details(Passenger const &passenger) const;
+
+  // Renumbers the slots from first on in order of appear time, keeping the
+  // insertion order of passengers that appear together. Only valid while no
+  // pointers to those slots are out and nothing was removed yet.
+  void sort_by_appear_time(std::uint32_t first = 0);
+
+  // The id lookup is only needed while duplicates can still arrive.
+  void release_id_index();
+
+  std::vector<std::uint32_t> slots_by_id() const;
+
+  size_t size() const noexcept { return m_size; }
+  size_t slots() const noexcept { return m_slots; }
+  size_t memory_usage() const noexcept;
+
+ private:
+  std::vector<std::unique_ptr<Passenger[]>> m_hot;
+  std::vector<std::unique_ptr<PassengerDetails[]>> m_cold;
+  std::vector<bool> m_live;
+  std::vector<std::uint32_t> m_free_slots;
+  std::unordered_map<size_t, std::uint32_t> m_slot_by_id;
+  bool m_indexing_ids = true;
+  size_t m_slots = 0;  // slots ever used, live or free
+  size_t m_size = 0;
+
+  Passenger &hot(size_t slot) const noexcept;
+  PassengerDetails &cold(size_t slot) const noexcept;
+};
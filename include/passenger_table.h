@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "passenger_file_parser.h"
+
+// A passengers file or binary trace parsed once into records sorted by
+// appear time and free of duplicate ids. It never changes after load(), so
+// any number of runs may read it from different threads at the same time.
+class PassengerTable final {
+ public:
+  static std::shared_ptr<PassengerTable const> load(std::string const &file);
+
+  std::span<PassengerRecord const> records() const noexcept {
+    return m_records;
+  }
+  size_t size() const noexcept { return m_records.size(); }
+
+  // Highest boarding or target floor, so a building can be checked up front.
+  size_t top_floor() const noexcept { return m_top_floor; }
+
+ private:
+  std::vector<PassengerRecord> m_records;
+  size_t m_top_floor = 0;
+};
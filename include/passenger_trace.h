@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+#include "passenger_file_parser.h"
+
+// Versioned binary columnar passenger trace. Records are sorted by appear
+// time (stable with respect to the text file they came from) and ids are
+// unique, so a loader can walk the columns in order without an index.
+//
+// Layout: PassengerTraceHeader, then one 8-byte aligned column per field.
+class PassengerTrace final {
+ public:
+  static constexpr char magic[8] = {'E', 'L', 'V', 'T', 'R', 'A', 'C', 'E'};
+  static constexpr std::uint32_t version = 1;
+
+  struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t header_size;
+    std::uint64_t count;
+    std::uint64_t id_offset;
+    std::uint64_t weight_offset;
+    std::uint64_t boarding_floor_offset;
+    std::uint64_t appear_time_offset;
+    std::uint64_t target_floor_offset;
+  };
+
+  explicit PassengerTrace(std::string const &file);
+
+  static bool is_binary_trace(std::string const &file);
+
+  // Sorts and deduplicates like the text loader does, then writes the file.
+  static void write(std::string const &file,
+                    std::vector<PassengerRecord> records);
+
+  // Keeps the first record of every id, then stable sorts by appear time.
+  static void sort_and_deduplicate(std::vector<PassengerRecord> &records);
+
+  size_t size() const noexcept { return m_ids.size(); }
+
+  std::span<std::uint64_t const> ids() const noexcept { return m_ids; }
+  std::span<double const> weights() const noexcept { return m_weights; }
+  std::span<std::uint32_t const> boarding_floors() const noexcept {
+    return m_boarding_floors;
+  }
+  std::span<std::uint64_t const> appear_times() const noexcept {
+    return m_appear_times;
+  }
+  std::span<std::uint32_t const> target_floors() const noexcept {
+    return m_target_floors;
+  }
+
+ private:
+  MappedFile m_file;
+  std::span<std::uint64_t const> m_ids;
+  std::span<double const> m_weights;
+  std::span<std::uint32_t const> m_boarding_floors;
+  std::span<std::uint64_t const> m_appear_times;
+  std::span<std::uint32_t const> m_target_floors;
+
+  template <typename T>
+  std::span<T const> column(std::uint64_t offset, std::uint64_t count,
+                            std::string const &file) const;
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Built with -DELEVATOR_PROFILING=0 the macros at the end compile to
+// nothing, and main --profile is refused.
+#ifndef ELEVATOR_PROFILING
+#define ELEVATOR_PROFILING 1
+#endif
+
+// Parts of modeling timed by PhaseProfiler. Phases nest, so their times are
+// inclusive: boarding runs inside floor arrivals, logging inside most.
+enum class Phase : std::uint8_t {
+  Load,              // items: passengers loaded
+  Model,             // the whole loop; items: passengers delivered
+  Tick,
+  ArrivePassengers,  // items: passengers appeared
+  Dispatch,          // items: hall calls assigned
+  FloorArrivals,     // items: elevators arrived
+  Deboarding,        // items: passengers delivered
+  Boarding,          // items: passengers boarded
+  EventScheduling,
+  Checkpoint,
+  Logging,  // calls: messages logged
+  Results,  // items: passengers written
+  Count,
+};
+
+// Told of every phase timed, as it ends, on the thread that ran it.
+class PhaseListener {
+ public:
+  virtual ~PhaseListener() = default;
+  virtual void phase_ended(Phase phase,
+                           std::chrono::steady_clock::time_point start,
+                           std::chrono::steady_clock::time_point end) = 0;
+};
+
+// Calls, items and steady_clock time per phase, summed over every thread
+// and every ElevatorSystem of the process. Each thread counts into a block
+// of its own, so parallel arrivals do not contend; report() adds them up
+// and is meant for after modeling.
+class PhaseProfiler final {
+ public:
+  static constexpr size_t phases_count = static_cast<size_t>(Phase::Count);
+
+  struct Counters {
+    std::uint64_t calls = 0;
+    std::uint64_t items = 0;
+    std::uint64_t nanoseconds = 0;
+  };
+
+  static void enable() noexcept {
+    s_enabled.store(true, std::memory_order_relaxed);
+  }
+  static bool enabled() noexcept {
+    return s_enabled.load(std::memory_order_relaxed);
+  }
+
+  // Phases are only timed once enabled; pass nullptr before the listener
+  // goes away.
+  static void set_listener(PhaseListener *listener) noexcept {
+    s_listener.store(listener, std::memory_order_release);
+  }
+  static PhaseListener *listener() noexcept {
+    return s_listener.load(std::memory_order_acquire);
+  }
+
+  static void add(Phase phase, std::uint64_t items,
+                  std::uint64_t nanoseconds) noexcept;
+  static std::array<Counters, phases_count> totals();
+  static char const *name(Phase phase) noexcept;
+
+  // One line per phase that ran, then ticks and deliveries per second of
+  // the Model phase.
+  static void report(std::ostream &out);
+
+ private:
+  static inline std::atomic<bool> s_enabled = false;
+  static inline std::atomic<PhaseListener *> s_listener = nullptr;
+};
+
+// Times one phase from construction to destruction, if profiling is on.
+class PhaseTimer final {
+ public:
+  explicit PhaseTimer(Phase phase) noexcept
+      : m_phase(phase), m_running(PhaseProfiler::enabled()) {
+    if (m_running) {
+      m_start = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~PhaseTimer() {
+    if (m_running) {
+      auto const end = std::chrono::steady_clock::now();
+      PhaseProfiler::add(
+          m_phase, m_items,
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_start)
+              .count());
+      if (PhaseListener *listener = PhaseProfiler::listener()) {
+        listener->phase_ended(m_phase, m_start, end);
+      }
+    }
+  }
+
+  PhaseTimer(PhaseTimer const &) = delete;
+  PhaseTimer &operator=(PhaseTimer const &) = delete;
+
+  void add_items(size_t count) noexcept { m_items += count; }
+
+ private:
+  Phase m_phase;
+  bool m_running;
+  std::uint64_t m_items = 0;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+#if ELEVATOR_PROFILING
+#define PROFILE_PHASE(timer, phase) PhaseTimer timer(phase)
+#define PROFILE_ITEMS(timer, count) (timer).add_items(count)
+#else
+#define PROFILE_PHASE(timer, phase) static_cast<void>(0)
+#define PROFILE_ITEMS(timer, count) static_cast<void>(0)
+#endif
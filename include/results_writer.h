@@ -0,0 +1,68 @@
+#pragma once
+
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Appends the decimal digits of value, as operator<< prints them.
+inline void append_number(std::string &out, size_t value) {
+  char digits[20];
+  auto const end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+  out.append(digits, end);
+}
+
+// Writes text to one file on a thread of its own, in the order it was
+// queued, so formatting results overlaps with writing them. Small records
+// are gathered in text() and queued a chunk at a time. At most max_pending
+// chunks wait at a time; queueing blocks beyond that instead of piling up
+// memory.
+class ResultsWriter final {
+ public:
+  static constexpr size_t max_pending = 4;
+  static constexpr size_t chunk_bytes = size_t{1} << 20;
+
+  // Check is_open(); nothing is written to a file that failed to open.
+  explicit ResultsWriter(std::string const &file);
+  // Writes what is still gathered or queued. Errors are lost here; call
+  // close() first to see them.
+  ~ResultsWriter();
+
+  ResultsWriter(ResultsWriter const &) = delete;
+  ResultsWriter &operator=(ResultsWriter const &) = delete;
+
+  bool is_open() const noexcept { return m_open; }
+
+  // Append records here, then call commit().
+  std::string &text() noexcept { return m_text; }
+  // Queues the gathered text once it makes a chunk.
+  void commit();
+  // Queues the gathered text, then this. Rethrows the first error of an
+  // earlier write.
+  void write(std::string text);
+  // Returns once every queued chunk is written and the file is closed;
+  // rethrows the first error.
+  void close();
+
+ private:
+  std::ofstream m_file;
+  std::string m_file_name;
+  bool m_open = false;
+  std::string m_text;
+
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::deque<std::string> m_chunks;
+  bool m_stopping = false;
+  std::exception_ptr m_error;
+  std::thread m_thread;
+
+  void queue(std::string text);
+  void run();
+  void rethrow_error();
+};
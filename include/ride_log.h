@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CheckpointReader;
+class CheckpointWriter;
+
+// Keeps one interval per ride instead of one entry per pair of co-riders.
+// "Met passengers" of a ride are the rides of the same elevator that were
+// already in the cabin when it boarded; they are derived on demand.
+class RideLog final {
+ public:
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  struct Ride {
+    size_t passenger_id;
+    size_t board_time;
+    size_t deboard_time;
+    // Boardings and deboardings may share a time unit, so the order inside
+    // an elevator is kept separately.
+    std::uint64_t board_sequence;
+    std::uint64_t deboard_sequence;
+    std::uint32_t cabin_size;  // riders already inside when boarding
+    std::uint32_t cabin_span;  // rides back to the oldest of those riders
+  };
+
+  // Makes room for elevator ids below count up front. Recording for
+  // different elevators then touches nothing shared and may run
+  // concurrently.
+  void reserve_elevators(size_t count);
+
+  size_t record_boarding(size_t elevator_id, size_t passenger_id, size_t time,
+                         size_t cabin_size);
+  void record_deboarding(size_t elevator_id, size_t ride, size_t time);
+
+  Ride const &ride(size_t elevator_id, size_t ride) const;
+  std::vector<size_t> met_passengers(size_t elevator_id, size_t ride) const;
+
+  // Forgets the rides of an elevator that no ride still in its cabin can
+  // have met. Streaming runs call it after deboardings, so the log only
+  // holds the recent history of each cabin.
+  void release_settled(size_t elevator_id);
+
+  size_t rides_count() const noexcept;
+
+  void save(CheckpointWriter &out) const;
+  void restore(CheckpointReader &in);
+
+ private:
+  struct ElevatorRides {
+    std::vector<Ride> rides;  // rides[i] is ride number first + i
+    size_t first = 0;
+    size_t released = 0;     // rides before this one are no longer needed
+    size_t oldest_open = 0;  // no ride before this one is in the cabin
+    // Sequence numbers are only compared within one elevator.
+    std::uint64_t sequence = 0;
+  };
+
+  std::vector<ElevatorRides> m_rides_by_elevator;
+
+  static void skip_closed_rides(ElevatorRides &log) noexcept;
+};
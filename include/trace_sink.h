@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "elevator.h"
+#include "phase_profiler.h"
+#include "results_writer.h"
+
+// Writes Chrome trace-event JSON, for chrome://tracing or Perfetto, as it is
+// told of events; the text goes through a ResultsWriter a chunk at a time,
+// so a trace of a whole day is never held in memory.
+//
+// The "Simulation" process shows model time, one time unit as one second:
+// a track per elevator with a span per state it was in for some time and an
+// instant per passenger boarding or deboarding, and counters of each cabin
+// load and each floor queue. The "Engine" process shows the wall clock: a
+// track per thread with a span per phase timed by PhaseProfiler, once this
+// is its listener, but for the phases of single arrivals and messages.
+//
+// Safe to call from several threads at once.
+class TraceSink final : public ElevatorObserver, public PhaseListener {
+ public:
+  // Throws if the file can not be opened.
+  explicit TraceSink(std::string const &file);
+  // Ends the JSON, but errors are lost here; call close() first to see
+  // them. Stops being the PhaseProfiler listener, if it is.
+  ~TraceSink() override;
+
+  TraceSink(TraceSink const &) = delete;
+  TraceSink &operator=(TraceSink const &) = delete;
+
+  // Names the track of the elevator.
+  void add_elevator(Elevator const &elevator);
+  void state_changed(Elevator const &elevator, ElevatorState from,
+                     size_t since, ElevatorState to, size_t time) override;
+  void passenger_boarded(Elevator const &elevator, size_t passenger_id,
+                         size_t floor, size_t time);
+  void passenger_deboarded(Elevator const &elevator, size_t passenger_id,
+                           size_t floor, size_t time);
+  void cabin_load(Elevator const &elevator, size_t time);
+  void floor_queue(size_t floor, size_t waiting, size_t time);
+
+  void phase_ended(Phase phase, std::chrono::steady_clock::time_point start,
+                   std::chrono::steady_clock::time_point end) override;
+
+  // Ends the JSON and returns once it is written; rethrows the first error
+  // of writing.
+  void close();
+
+ private:
+  static constexpr size_t simulation_pid = 1;
+  static constexpr size_t engine_pid = 2;
+
+  std::mutex m_mutex;
+  ResultsWriter m_writer;
+  std::chrono::steady_clock::time_point const m_start;
+  std::unordered_map<std::thread::id, size_t> m_threads;
+
+  // Per elevator id, the last state span, still written only once the
+  // next one does not continue it.
+  struct StateSpan {
+    ElevatorState state;
+    size_t start;
+    size_t end;
+    size_t floor;  // where the elevator was when it entered the state
+  };
+  std::unordered_map<size_t, StateSpan> m_open_spans;
+  bool m_closed = false;
+  std::exception_ptr m_error;
+
+  // These append to m_writer.text(); m_mutex must be held.
+  void write_span(size_t elevator_id, StateSpan const &span);
+  void end_trace();
+  void begin_event(char const *name, char phase, size_t pid, size_t tid);
+  void end_event();
+  void commit();
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "passenger_file_parser.h"
+
+// Distributions a synthetic day of traffic is drawn from. Time is in the
+// units of the passengers file, where "hh:mm" is hh * 60 + mm.
+struct TrafficProfile {
+  // Expected passengers per hour (60 time units), one entry per hour of the
+  // day; the day ends with the last entry.
+  std::vector<double> hourly_rates;
+  // floors_count x floors_count relative weights of trips, row = origin
+  // floor - 1, column = target floor - 1. The diagonal is ignored.
+  std::vector<double> trips;
+  size_t floors_count = 0;
+
+  // Normal distribution of passenger weights, redrawn until it falls into
+  // [min_weight, max_weight].
+  double mean_weight = 75;
+  double weight_deviation = 15;
+  double min_weight = 30;
+  double max_weight = 150;
+
+  // The same rate all day and every trip between two floors equally likely.
+  static TrafficProfile uniform(size_t floors_count, double hourly_rate,
+                                size_t hours = 24);
+
+  double trip_weight(size_t from, size_t to) const {
+    return trips[(from - 1) * floors_count + to - 1];
+  }
+  double &trip_weight(size_t from, size_t to) {
+    return trips[(from - 1) * floors_count + to - 1];
+  }
+};
+
+// Reads a profile for a building of floors_count floors. Lines hold one
+// setting each, '#' starts a comment:
+//   rates <passengers per hour>...     one value per hour, in order
+//   trip <from> <to> <weight>          replaces the weight of one trip
+//   weight <mean> <deviation> <min> <max>
+// Trips default to the uniform matrix and rates to 60 passengers an hour.
+TrafficProfile parse_traffic_profile(std::string const &file,
+                                     size_t floors_count);
+
+// Draws passengers from a profile. A seed always yields the same passengers:
+// sampling is done here on a splitmix64 stream rather than with the std
+// distributions, whose output differs between standard libraries.
+class TrafficGenerator final {
+ public:
+  explicit TrafficGenerator(TrafficProfile profile);
+
+  // Passengers of one day, sorted by appear time, with ids from 1.
+  std::vector<PassengerRecord> generate(std::uint64_t seed) const;
+
+  TrafficProfile const &profile() const noexcept { return m_profile; }
+
+ private:
+  TrafficProfile m_profile;
+  std::vector<double> m_cumulative_trips;  // running sum over m_profile.trips
+};
+
+// Seed of the index-th of a series of runs started from base_seed, spread
+// out so that neighbouring runs do not draw correlated traffic.
+std::uint64_t scenario_seed(std::uint64_t base_seed, size_t index) noexcept;
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "elevator_system.h"
+#include "passenger_table.h"
+
+// A change to the baseline run: new max loads by elevator id, and passengers
+// on top of those in the trace.
+struct WhatIfScenario {
+  std::vector<std::pair<size_t, double>> max_loads;
+  std::vector<PassengerRecord> added_passengers;
+};
+
+struct WhatIfResult {
+  // Nothing before this time can come out differently from the baseline.
+  size_t earliest_effect = 0;
+  // Checkpoint the run resumed from; empty when it was modeled from scratch.
+  std::optional<size_t> resumed_from;
+  // Earliest time a passenger of the trace boarded or left differently.
+  std::optional<size_t> first_divergence;
+  size_t diverged_passengers = 0;
+  std::vector<PassengerResult> passengers;
+  PassengerTotals totals;
+  size_t end_time = 0;
+  double seconds = 0;
+};
+
+// Models a passenger table once as a baseline, keeping checkpoints in memory,
+// and then answers "what if" one thing had been different by resuming from
+// the last checkpoint before the change can matter. Memory grows with the
+// number of checkpoints times the size of the state.
+class WhatIf final {
+ public:
+  static constexpr size_t default_checkpoint_interval = 60;
+
+  WhatIf(size_t floors_count, std::vector<double> max_loads,
+         std::shared_ptr<PassengerTable const> passengers);
+
+  // These apply to the baseline and every scenario, so they drop the
+  // checkpoints of an earlier baseline.
+  WhatIf &set_policy(std::string const &name);
+  WhatIf &set_mode(SimulationMode mode) noexcept;
+  WhatIf &set_time_limit(size_t limit) noexcept;
+  WhatIf &set_checkpoint_interval(size_t interval);
+
+  WhatIfResult const &run_baseline();
+  // Runs after run_baseline(); from_scratch models the whole trace instead,
+  // which has to give the same results.
+  WhatIfResult run(WhatIfScenario const &scenario,
+                   bool from_scratch = false) const;
+
+  size_t checkpoints_count() const noexcept { return m_checkpoints.size(); }
+
+ private:
+  // An elevator is used once something boarded it or tried to. Until then
+  // its max load only matters for how it compares to the other ones.
+  struct Checkpoint {
+    size_t time = 0;
+    std::vector<char> image;
+    std::vector<bool> used;
+  };
+
+  size_t m_floors_count;
+  std::vector<double> m_max_loads;
+  std::shared_ptr<PassengerTable const> m_passengers;
+  SimulationMode m_mode = SimulationMode::Event;
+  size_t m_time_limit = std::numeric_limits<size_t>::max();
+  size_t m_checkpoint_interval = default_checkpoint_interval;
+  std::vector<Checkpoint> m_checkpoints;
+  std::optional<WhatIfResult> m_baseline;
+  WhatIfResult (WhatIf::*m_model)(std::vector<double> const &,
+                                  std::span<PassengerRecord const>,
+                                  Checkpoint const *,
+                                  std::vector<Checkpoint> *) const =
+      &WhatIf::model<NearestSuitableDispatch>;
+
+  size_t earliest_effect(WhatIfScenario const &scenario) const;
+  void compare_with_baseline(WhatIfResult &result) const;
+
+  // Models the trace and the added passengers on elevators with these max
+  // loads, resuming from `from` if given. Checkpoints of the run go to
+  // `checkpoints` if given.
+  template <DispatchPolicy Policy>
+  WhatIfResult model(std::vector<double> const &max_loads,
+                     std::span<PassengerRecord const> added,
+                     Checkpoint const *from,
+                     std::vector<Checkpoint> *checkpoints) const;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs tasks 0..count-1 on a fixed set of threads. Every thread starts on its
+// own contiguous share of the indices, takes them from the front, and once
+// it runs dry steals from the back of another thread's share. Tasks of very
+// different cost thus still keep all threads busy to the end.
+//
+// The threads live as long as the pool and sleep between runs, so run() is
+// cheap enough to call once per simulated tick.
+class WorkStealingPool final {
+ public:
+  // 0 uses every hardware thread. The calling thread is one of them.
+  explicit WorkStealingPool(size_t threads = 0);
+  ~WorkStealingPool();
+
+  WorkStealingPool(WorkStealingPool const &) = delete;
+  WorkStealingPool &operator=(WorkStealingPool const &) = delete;
+
+  // Returns once every task ran. If tasks throw, the first exception is
+  // rethrown here after the others finished.
+  void run(size_t count, std::function<void(size_t)> const &task);
+
+  size_t threads() const noexcept { return m_threads; }
+
+ private:
+  struct Share;
+
+  size_t m_threads;
+  std::unique_ptr<Share[]> m_shares;
+  std::vector<std::thread> m_workers;
+
+  std::mutex m_mutex;
+  std::condition_variable m_start;
+  std::condition_variable m_done;
+  std::function<void(size_t)> const *m_task = nullptr;
+  size_t m_generation = 0;  // bumped by every run()
+  size_t m_busy = 0;        // workers still inside the current run
+  bool m_stopping = false;
+  std::exception_ptr m_error;
+
+  void serve(size_t self);
+  void drain(size_t self);
+};
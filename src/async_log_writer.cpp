@@ -0,0 +1,151 @@
+#include "async_log_writer.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+async_log_writer::async_log_writer(stream_table streams,
+                                   settings const &writer_settings)
+    : _streams(std::move(streams)),
+      _settings(writer_settings),
+      _queue(std::bit_ceil(
+          std::max<size_t>(writer_settings.queue_capacity, 2))) {
+  if (_settings.batch_size == 0) {
+    throw std::invalid_argument("Async log batch size must be positive");
+  }
+
+  for (auto const &severity_streams : _streams) {
+    _all_streams.insert(severity_streams.second.begin(),
+                        severity_streams.second.end());
+  }
+
+  _writer = std::thread(&async_log_writer::run, this);
+}
+
+async_log_writer::~async_log_writer() noexcept {
+  {
+    std::lock_guard<std::mutex> lock(_wake_mutex);
+    _stopping = true;
+  }
+  _wake.notify_one();
+  _writer.join();
+}
+
+void async_log_writer::push(std::string &&message,
+                            logger::severity severity) noexcept {
+  record item{std::move(message), severity};
+
+  if (!_queue.try_push(std::move(item))) {
+    if (_settings.policy != overflow_policy::block) {
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+      wake_writer();
+      return;
+    }
+
+    do {
+      wake_writer();
+      std::this_thread::yield();
+    } while (!_queue.try_push(std::move(item)));
+  }
+
+  if (_queue.size_approx() >= _settings.batch_size) {
+    wake_writer();
+  }
+}
+
+void async_log_writer::wake_writer() noexcept {
+  if (_writer_waiting.load(std::memory_order_acquire)) {
+    _wake.notify_one();
+  }
+}
+
+void async_log_writer::run() {
+  pending_lines pending;
+  std::set<shared_log_stream *> dirty;
+  auto last_flush = std::chrono::steady_clock::now();
+  record item;
+
+  while (true) {
+    bool stopping;
+    {
+      std::lock_guard<std::mutex> lock(_wake_mutex);
+      stopping = _stopping;
+    }
+
+    size_t written = 0;
+    while (written < _settings.batch_size && _queue.try_pop(item)) {
+      write_record(item, pending);
+      ++written;
+    }
+    report_dropped(pending);
+    write_pending(pending, dirty);
+
+    auto const now = std::chrono::steady_clock::now();
+    bool const interval_elapsed = now - last_flush >= _settings.flush_interval;
+
+    if (written == _settings.batch_size || interval_elapsed ||
+        (written == 0 && stopping)) {
+      flush_streams(dirty);
+      last_flush = now;
+    }
+
+    if (written == 0) {
+      if (stopping) {
+        return;
+      }
+
+      std::unique_lock<std::mutex> lock(_wake_mutex);
+      _writer_waiting.store(true, std::memory_order_release);
+      _wake.wait_for(lock, _settings.flush_interval, [this] {
+        return _stopping || _queue.size_approx() >= _settings.batch_size;
+      });
+      _writer_waiting.store(false, std::memory_order_relaxed);
+    }
+  }
+}
+
+void async_log_writer::write_record(record const &item,
+                                    pending_lines &pending) const {
+  auto it = _streams.find(item.severity);
+  if (it == _streams.cend()) {
+    return;
+  }
+
+  for (auto *stream : it->second) {
+    std::string &lines = pending[stream];
+    lines += item.message;
+    lines += '\n';
+  }
+}
+
+void async_log_writer::report_dropped(pending_lines &pending) {
+  size_t const dropped = _dropped.exchange(0, std::memory_order_relaxed);
+  if (dropped == 0 || _settings.policy != overflow_policy::drop_and_count) {
+    return;
+  }
+
+  for (auto *stream : _all_streams) {
+    pending[stream] += "Dropped " + std::to_string(dropped) +
+                       " log records: async queue overflow\n";
+  }
+}
+
+// Buffers are cleared but kept, so their capacity is reused next batch.
+void async_log_writer::write_pending(pending_lines &pending,
+                                     std::set<shared_log_stream *> &dirty) {
+  for (auto &[stream, lines] : pending) {
+    if (!lines.empty()) {
+      stream->write(lines, false);
+      lines.clear();
+      dirty.insert(stream);
+    }
+  }
+}
+
+void async_log_writer::flush_streams(std::set<shared_log_stream *> &dirty) {
+  for (auto *stream : dirty) {
+    stream->flush();
+  }
+  dirty.clear();
+}
@@ -0,0 +1,130 @@
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+CheckpointWriter::CheckpointWriter() {
+  append(magic, sizeof(magic));
+  put(version);
+}
+
+void CheckpointWriter::append(void const *data, size_t size) {
+  size_t const offset = m_bytes.size();
+  m_bytes.resize(offset + size);
+  std::memcpy(m_bytes.data() + offset, data, size);
+}
+
+CheckpointReader::CheckpointReader(std::span<char const> bytes)
+    : m_bytes(bytes) {
+  size_t const header_size =
+      sizeof(CheckpointWriter::magic) + sizeof(CheckpointWriter::version);
+  if (m_bytes.size() < header_size ||
+      std::memcmp(m_bytes.data(), CheckpointWriter::magic,
+                  sizeof(CheckpointWriter::magic)) != 0) {
+    throw std::runtime_error("Not a simulation checkpoint");
+  }
+  m_offset = sizeof(CheckpointWriter::magic);
+
+  auto const image_version = get<std::uint32_t>();
+  if (image_version != CheckpointWriter::version) {
+    throw std::runtime_error("Unsupported checkpoint version " +
+                             std::to_string(image_version));
+  }
+}
+
+char const *CheckpointReader::take(size_t size) {
+  if (size > remaining()) {
+    throw std::runtime_error("Checkpoint is truncated");
+  }
+  char const *data = m_bytes.data() + m_offset;
+  m_offset += size;
+  return data;
+}
+
+CheckpointSaver::CheckpointSaver() : m_thread(&CheckpointSaver::run, this) {}
+
+CheckpointSaver::~CheckpointSaver() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_changed.notify_all();
+  m_thread.join();
+}
+
+void CheckpointSaver::save(std::string file, std::vector<char> image) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_changed.wait(lock, [this] {
+    return m_error || m_jobs.size() < max_pending;
+  });
+  rethrow_error();
+  m_jobs.push_back({std::move(file), std::move(image)});
+  lock.unlock();
+  m_changed.notify_all();
+}
+
+void CheckpointSaver::wait() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_changed.wait(lock, [this] { return m_jobs.empty() && !m_writing; });
+  rethrow_error();
+}
+
+void CheckpointSaver::rethrow_error() {
+  if (m_error) {
+    std::rethrow_exception(std::exchange(m_error, nullptr));
+  }
+}
+
+void CheckpointSaver::run() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_changed.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+    if (m_jobs.empty()) {
+      return;
+    }
+
+    Job job = std::move(m_jobs.front());
+    m_jobs.pop_front();
+    m_writing = true;
+    lock.unlock();
+    m_changed.notify_all();
+
+    std::exception_ptr error;
+    try {
+      write_file(job.file, job.image);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+    m_writing = false;
+    if (error && !m_error) {
+      m_error = error;
+    }
+    m_changed.notify_all();
+  }
+}
+
+void CheckpointSaver::write_file(std::string const &file,
+                                 std::span<char const> image) {
+  std::string const temporary = file + ".tmp";
+  {
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      throw std::runtime_error("Failed to open checkpoint file: " + temporary);
+    }
+    out.write(image.data(), static_cast<std::streamsize>(image.size()));
+    if (!out.flush()) {
+      throw std::runtime_error("Failed to write checkpoint: " + temporary);
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporary, file, error);
+  if (error) {
+    std::remove(temporary.c_str());
+    throw std::runtime_error("Failed to move checkpoint into place: " + file +
+                             " (" + error.message() + ")");
+  }
+}
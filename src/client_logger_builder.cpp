@@ -21,30 +21,42 @@ client_logger_builder::client_logger_builder() {
     _streams_info[severity.first] =
         std::make_pair(std::set<std::string>(), severity.second);
   }
-
-  _log_format = "%m";
 }
 
 logger_builder *client_logger_builder::set_log_format(
     std::string const &format) {
-  const std::set<char> valid_placeholders = {'d', 't', 's', 'm'};
+  _log_format = log_format(format);
+  return this;
+}
 
-  for (int i = 0; i < format.length(); ++i) {
-    if (format[i] == '%') {
-      if (i + 1 >= format.length()) {
-        throw std::invalid_argument(
-            "Incomplete placeholder at end of format string");
-      }
-      char placeholder = format[i + 1];
-      if (valid_placeholders.find(placeholder) == valid_placeholders.end()) {
-        throw std::invalid_argument("Invalid placeholder %" +
-                                    std::string(1, placeholder));
-      }
-      ++i;
-    }
+logger_builder *client_logger_builder::set_async_mode(
+    async_log_writer::settings const &settings) {
+  if (settings.queue_capacity == 0) {
+    throw std::invalid_argument("Async log queue capacity must be positive");
+  }
+  if (settings.batch_size == 0) {
+    throw std::invalid_argument("Async log batch size must be positive");
   }
 
-  _log_format = format;
+  _async_settings = settings;
+  return this;
+}
+
+logger_builder *client_logger_builder::set_sync_mode() {
+  _async_settings.reset();
+  return this;
+}
+
+logger_builder *client_logger_builder::set_mapped_file_mode(
+    mapped_log_file::settings const &settings) {
+  mapped_log_file::validate(settings);
+
+  _mapped_settings = settings;
+  return this;
+}
+
+logger_builder *client_logger_builder::set_stream_file_mode() {
+  _mapped_settings.reset();
   return this;
 }
 
@@ -91,6 +103,31 @@ logger_builder *client_logger_builder::transform_with_configuration(
 
   set_log_format(parsed_config.at("format"));
 
+  if (parsed_config.contains("async")) {
+    auto const &async_config_section = parsed_config.at("async");
+    async_log_writer::settings settings;
+    settings.queue_capacity =
+        async_config_section.value("capacity", settings.queue_capacity);
+    settings.batch_size =
+        async_config_section.value("batch_size", settings.batch_size);
+    settings.flush_interval = std::chrono::milliseconds(
+        async_config_section.value("flush_interval_ms",
+                                   settings.flush_interval.count()));
+    settings.policy = string_to_overflow_policy(
+        async_config_section.value("overflow", std::string("block")));
+    set_async_mode(settings);
+  }
+
+  if (parsed_config.contains("mapped")) {
+    auto const &mapped_config_section = parsed_config.at("mapped");
+    mapped_log_file::settings settings;
+    settings.segment_size =
+        mapped_config_section.value("segment_size", settings.segment_size);
+    settings.max_segments =
+        mapped_config_section.value("max_segments", settings.max_segments);
+    set_mapped_file_mode(settings);
+  }
+
   auto streams_config_section = parsed_config.at("streams");
   for (auto const stream_config_section : streams_config_section) {
     std::string target_file_absolute_path;
@@ -128,7 +165,8 @@ logger_builder *client_logger_builder::clear() {
 }
 
 logger *client_logger_builder::build() const {
-  return new client_logger(_streams_info, _log_format);
+  return new client_logger(_streams_info, _log_format, _async_settings,
+                           _mapped_settings);
 }
 
 std::string client_logger_builder::convert_to_absolute(
@@ -139,3 +177,19 @@ std::string client_logger_builder::convert_to_absolute(
 
   return path;
 }
+
+async_log_writer::overflow_policy
+client_logger_builder::string_to_overflow_policy(
+    std::string const &policy_string) {
+  if (policy_string == "block") {
+    return async_log_writer::overflow_policy::block;
+  }
+  if (policy_string == "drop") {
+    return async_log_writer::overflow_policy::drop;
+  }
+  if (policy_string == "count") {
+    return async_log_writer::overflow_policy::drop_and_count;
+  }
+
+  throw std::invalid_argument("Invalid overflow policy " + policy_string);
+}
@@ -0,0 +1,27 @@
+#include "deferred_logger.h"
+
+deferred_logger::deferred_logger(logger const *target) noexcept
+    : _target(target) {}
+
+logger const *deferred_logger::log(std::string const &message,
+                                   logger::severity severity) const noexcept {
+  try {
+    _records.emplace_back(message, severity);
+  } catch (...) {
+    // Same as a stream that failed to write: the message is lost.
+  }
+  return this;
+}
+
+bool deferred_logger::is_enabled(logger::severity severity) const noexcept {
+  return _target != nullptr && _target->is_enabled(severity);
+}
+
+void deferred_logger::replay() {
+  if (_target != nullptr) {
+    for (auto const &[message, severity] : _records) {
+      _target->log(message, severity);
+    }
+  }
+  _records.clear();
+}
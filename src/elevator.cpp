@@ -5,13 +5,16 @@
 #include <iostream>
 #include <stdexcept>
 
+#include "checkpoint.h"
+#include "passenger_store.h"
+
 Elevator::Elevator(size_t id, int starting_floor, double max_load,
                    size_t total_floors, ElevatorState initial_state)
     : m_current_floor(starting_floor),
       m_state(initial_state),
       m_current_load(0.0),
       m_max_load(max_load),
-      m_pressed_buttons(total_floors + 1, false),
+      m_pressed_buttons(total_floors + 1),
       m_id(id) {
   if (starting_floor < 1) {
     throw std::invalid_argument("Starting floor must be positive");
@@ -30,7 +33,10 @@ size_t Elevator::current_floor() const noexcept { return m_current_floor; }
 ElevatorState Elevator::state() const noexcept { return m_state; }
 double Elevator::current_load() const noexcept { return m_current_load; }
 double Elevator::max_load() const noexcept { return m_max_load; }
-std::vector<bool> &Elevator::pressed_buttons() noexcept {
+FloorBitset &Elevator::pressed_buttons() noexcept {
+  return m_pressed_buttons;
+}
+FloorBitset const &Elevator::pressed_buttons() const noexcept {
   return m_pressed_buttons;
 }
 
@@ -47,16 +53,12 @@ size_t Elevator::overloads_count() const noexcept { return m_overloads_count; }
 
 bool Elevator::try_move_passenger_in(Passenger *p) {
   if (m_current_load + p->weight() > m_max_load) {
-    p->set_overload_lift();
     ++m_overloads_count;
     return false;
   }
 
-  for (auto const &person : m_passengers) {
-    p->add_met_passenger(person);
-  }
   m_passengers.push_back(p);
-  m_pressed_buttons[p->target_floor()] = true;
+  m_pressed_buttons.set(p->target_floor());
   m_current_load += p->weight();
   m_total_cargo += p->weight();
   m_max_load_reached = std::max(m_current_load, m_max_load_reached);
@@ -64,6 +66,10 @@ bool Elevator::try_move_passenger_in(Passenger *p) {
 }
 
 void Elevator::set_state(ElevatorState st, size_t current_time) {
+  if (m_observer != nullptr) {
+    m_observer->state_changed(*this, m_state, m_timestamp_when_last_state_set,
+                              st, current_time);
+  }
   size_t action_time = current_time - m_timestamp_when_last_state_set;
   switch (m_state) {
     case ElevatorState::MovingDown:
@@ -81,14 +87,21 @@ void Elevator::set_state(ElevatorState st, size_t current_time) {
   m_state = st;
 }
 
+void Elevator::set_observer(ElevatorObserver *observer) noexcept {
+  m_observer = observer;
+}
+
 std::vector<Passenger *> &Elevator::passengers() { return m_passengers; }
+std::vector<Passenger *> const &Elevator::passengers() const {
+  return m_passengers;
+}
 
 void Elevator::move_passenger_out(std::vector<Passenger *>::iterator &it) {
   Passenger *passenger = *it;
 
   // Update elevator stats
   m_current_load -= passenger->weight();
-  m_pressed_buttons[passenger->target_floor()] = false;
+  m_pressed_buttons.reset(passenger->target_floor());
 
   it = m_passengers.erase(it);
 }
@@ -132,6 +145,10 @@ void Elevator::calculate_moving_time_with_interrupt(size_t current_time,
 
 size_t Elevator::time_travel_ends() const { return m_time_travel_ends; }
 
+size_t Elevator::last_state_time() const noexcept {
+  return m_timestamp_when_last_state_set;
+}
+
 void Elevator::set_target_floor(size_t floor) { m_target_floor = floor; }
 
 size_t Elevator::id() const { return m_id; }
@@ -169,3 +186,58 @@ size_t Elevator::elevator_aproximate_floor(size_t time) const {
 
   return aproximate_floor;
 }
+
+void Elevator::save(CheckpointWriter &out) const {
+  out.put<std::uint64_t>(m_current_floor);
+  out.put(m_state);
+  out.put(m_current_load);
+  out.put<std::uint64_t>(m_target_floor);
+  out.put<std::uint64_t>(m_timestamp_when_last_state_set);
+  out.put<std::uint64_t>(m_time_travel_ends);
+  out.put<std::uint64_t>(m_idle_time);
+  out.put<std::uint64_t>(m_moving_time);
+  out.put<std::uint64_t>(m_floors_passed);
+  out.put(m_total_cargo);
+  out.put(m_max_load_reached);
+  out.put<std::uint64_t>(m_overloads_count);
+
+  std::vector<std::uint32_t> buttons;
+  for (size_t floor = m_pressed_buttons.find_next(0);
+       floor != FloorBitset::npos;
+       floor = m_pressed_buttons.find_next(floor + 1)) {
+    buttons.push_back(static_cast<std::uint32_t>(floor));
+  }
+  out.put_vector<std::uint32_t>(buttons);
+
+  std::vector<std::uint32_t> riders;
+  riders.reserve(m_passengers.size());
+  for (Passenger const *passenger : m_passengers) {
+    riders.push_back(passenger->slot());
+  }
+  out.put_vector<std::uint32_t>(riders);
+}
+
+void Elevator::restore(CheckpointReader &in, PassengerStore &passengers) {
+  m_current_floor = in.get<std::uint64_t>();
+  m_state = in.get<ElevatorState>();
+  m_current_load = in.get<double>();
+  m_target_floor = in.get<std::uint64_t>();
+  m_timestamp_when_last_state_set = in.get<std::uint64_t>();
+  m_time_travel_ends = in.get<std::uint64_t>();
+  m_idle_time = in.get<std::uint64_t>();
+  m_moving_time = in.get<std::uint64_t>();
+  m_floors_passed = in.get<std::uint64_t>();
+  m_total_cargo = in.get<double>();
+  m_max_load_reached = in.get<double>();
+  m_overloads_count = in.get<std::uint64_t>();
+
+  m_pressed_buttons = FloorBitset(m_pressed_buttons.size());
+  for (std::uint32_t floor : in.get_vector<std::uint32_t>()) {
+    m_pressed_buttons.set(floor);
+  }
+
+  m_passengers.clear();
+  for (std::uint32_t slot : in.get_vector<std::uint32_t>()) {
+    m_passengers.push_back(&passengers.at(slot));
+  }
+}
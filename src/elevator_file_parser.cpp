@@ -0,0 +1,71 @@
+#include "elevator_file_parser.h"
+
+#include <fstream>
+#include <stdexcept>
+
+std::pair<std::vector<Elevator>, size_t> parse_elevators_file(
+    std::string const &file) {
+  std::ifstream fin(file);
+  if (!fin.is_open()) {
+    throw std::runtime_error("Failed to open configuration file: " + file);
+  }
+
+  fin.seekg(0, std::ios::end);
+  if (fin.tellg() == 0) {
+    throw std::runtime_error("Configuration file is empty: " + file);
+  }
+  fin.seekg(0, std::ios::beg);
+
+  size_t n_floors = 0;
+  size_t k_elevators = 0;
+
+  if (!(fin >> n_floors >> k_elevators)) {
+    throw std::runtime_error("Failed to read number of floors and elevators");
+  }
+
+  if (n_floors == 0 && n_floors == 1) {
+    throw std::runtime_error("Number of floors (n) must be greater than 1");
+  }
+  if (k_elevators == 0) {
+    throw std::runtime_error("Number of elevators (k) must be positive");
+  }
+
+  std::vector<double> max_loads;
+  max_loads.reserve(k_elevators);
+
+  for (size_t i = 0; i < k_elevators; ++i) {
+    double max_load;
+    if (!(fin >> max_load)) {
+      throw std::runtime_error("Failed to read max_load for elevator " +
+                               std::to_string(i + 1) + ". Expected " +
+                               std::to_string(k_elevators) + " values");
+    }
+
+    if (max_load <= 0) {
+      throw std::runtime_error(
+          "Invalid max_load for elevator " + std::to_string(i + 1) +
+          ": must be positive (got " + std::to_string(max_load) + ")");
+    }
+    max_loads.push_back(max_load);
+  }
+
+  std::string extra_data;
+  if (fin >> extra_data) {
+    throw std::runtime_error(
+        "Unexpected data in configuration file after elevator specifications: "
+        "'" +
+        extra_data + "'");
+  }
+
+  return {make_elevators(n_floors, max_loads), n_floors};
+}
+
+std::vector<Elevator> make_elevators(size_t floors_count,
+                                     std::vector<double> const &max_loads) {
+  std::vector<Elevator> elevators;
+  elevators.reserve(max_loads.size());
+  for (size_t i = 0; i < max_loads.size(); ++i) {
+    elevators.emplace_back(i + 1, 1, max_loads[i], floors_count);
+  }
+  return elevators;
+}
@@ -0,0 +1,346 @@
+#include "fleet_state.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr auto idle_closed =
+    static_cast<std::uint8_t>(ElevatorState::IdleClosed);
+constexpr auto idle_open = static_cast<std::uint8_t>(ElevatorState::IdleOpen);
+constexpr auto moving_up = static_cast<std::uint8_t>(ElevatorState::MovingUp);
+constexpr auto moving_down =
+    static_cast<std::uint8_t>(ElevatorState::MovingDown);
+
+constexpr int unsuitable = std::numeric_limits<int>::max();
+
+bool is_suitable(std::uint8_t state, int approximate, int floor) noexcept {
+  switch (state) {
+    case idle_closed:
+    case idle_open:
+      return true;
+    case moving_up:
+      return approximate <= floor;
+    case moving_down:
+      return approximate >= floor;
+    default:
+      return false;
+  }
+}
+
+#if defined(__x86_64__)
+
+// Exact uint64 -> double with a single rounding, like the scalar cast: the
+// high and low halves are converted exactly through the 2^84 and 2^52
+// exponents and only their sum rounds.
+__attribute__((target("avx2"))) __m256d to_double(__m256i value) {
+  __m256i const low_exponent = _mm256_set1_epi64x(0x4330000000000000);
+  __m256i const high_exponent = _mm256_set1_epi64x(0x4530000000000000);
+  __m256d const both_exponents = _mm256_set1_pd(0x1.00000001p84);
+
+  __m256i const low = _mm256_blend_epi32(low_exponent, value, 0x55);
+  __m256i const high =
+      _mm256_or_si256(_mm256_srli_epi64(value, 32), high_exponent);
+  return _mm256_add_pd(
+      _mm256_sub_pd(_mm256_castsi256_pd(high), both_exponents),
+      _mm256_castsi256_pd(low));
+}
+
+// Low halves of four 64-bit lane masks, as four 32-bit lane masks.
+__attribute__((target("avx2"))) __m128i narrow(__m256i mask) {
+  __m256i const even = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+  return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(mask, even));
+}
+
+__attribute__((target("avx2"))) void approximate_floors_avx2(
+    std::uint8_t const *state, std::uint32_t const *current_floor,
+    std::uint32_t const *target_floor, std::uint64_t const *state_time,
+    std::uint64_t const *travel_ends, size_t count, std::uint64_t time,
+    int *out) {
+  __m256i const sign =
+      _mm256_set1_epi64x(std::numeric_limits<long long>::min());
+  __m256i const now = _mm256_set1_epi64x(static_cast<long long>(time));
+  __m256i const now_signed = _mm256_xor_si256(now, sign);
+  __m256i const up = _mm256_set1_epi64x(moving_up);
+  __m256i const down = _mm256_set1_epi64x(moving_down);
+
+  for (size_t i = 0; i < count; i += 4) {
+    std::int32_t states;
+    std::memcpy(&states, state + i, sizeof(states));
+    __m256i const lane_state =
+        _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(states));
+    __m256i const started =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(state_time + i));
+    __m256i const ends =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(travel_ends + i));
+    __m128i const current =
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(current_floor + i));
+    __m128i const target =
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(target_floor + i));
+
+    // Unsigned compares through the sign-flipped signed ones.
+    __m256i const moving =
+        _mm256_or_si256(_mm256_cmpeq_epi64(lane_state, up),
+                        _mm256_cmpeq_epi64(lane_state, down));
+    __m256i const after_start = _mm256_cmpgt_epi64(
+        now_signed, _mm256_xor_si256(started, sign));
+    __m256i const before_end =
+        _mm256_cmpgt_epi64(_mm256_xor_si256(ends, sign), now_signed);
+    __m256i const no_travel = _mm256_cmpeq_epi64(ends, started);
+
+    __m256i const interpolate = _mm256_andnot_si256(
+        no_travel, _mm256_and_si256(moving, after_start));
+    __m256i const at_target = _mm256_andnot_si256(before_end, interpolate);
+    __m256i const in_between = _mm256_and_si256(before_end, interpolate);
+
+    __m256d const percentage =
+        _mm256_div_pd(to_double(_mm256_sub_epi64(now, started)),
+                      to_double(_mm256_sub_epi64(ends, started)));
+    __m256d const floor_diff = _mm256_sub_pd(_mm256_cvtepi32_pd(target),
+                                             _mm256_cvtepi32_pd(current));
+    __m128i const passed =
+        _mm256_cvttpd_epi32(_mm256_mul_pd(floor_diff, percentage));
+
+    __m128i result = current;
+    result = _mm_blendv_epi8(result, target, narrow(at_target));
+    result = _mm_blendv_epi8(result, _mm_add_epi32(current, passed),
+                             narrow(in_between));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), result);
+  }
+}
+
+// Distance of every elevator to the floor, or `unsuitable`; returns the
+// smallest.
+__attribute__((target("avx2"))) int distances_avx2(std::uint8_t const *state,
+                                                   int const *approximate,
+                                                   size_t count, int floor,
+                                                   int *out) {
+  __m256i const target = _mm256_set1_epi32(floor);
+  __m256i const closed = _mm256_set1_epi32(idle_closed);
+  __m256i const open = _mm256_set1_epi32(idle_open);
+  __m256i const up = _mm256_set1_epi32(moving_up);
+  __m256i const down = _mm256_set1_epi32(moving_down);
+  __m256i const none = _mm256_set1_epi32(unsuitable);
+  __m256i nearest = none;
+
+  for (size_t i = 0; i < count; i += 8) {
+    __m256i const lane_state = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<__m128i const *>(state + i)));
+    __m256i const floors =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(approximate + i));
+
+    __m256i const idle = _mm256_or_si256(_mm256_cmpeq_epi32(lane_state, closed),
+                                         _mm256_cmpeq_epi32(lane_state, open));
+    __m256i const up_from_below =
+        _mm256_andnot_si256(_mm256_cmpgt_epi32(floors, target),
+                            _mm256_cmpeq_epi32(lane_state, up));
+    __m256i const down_from_above =
+        _mm256_andnot_si256(_mm256_cmpgt_epi32(target, floors),
+                            _mm256_cmpeq_epi32(lane_state, down));
+    __m256i const suitable = _mm256_or_si256(
+        idle, _mm256_or_si256(up_from_below, down_from_above));
+
+    __m256i const distance = _mm256_blendv_epi8(
+        none, _mm256_abs_epi32(_mm256_sub_epi32(floors, target)), suitable);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), distance);
+    nearest = _mm256_min_epi32(nearest, distance);
+  }
+
+  alignas(32) int lanes[8];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), nearest);
+  return *std::min_element(lanes, lanes + 8);
+}
+
+// Writes the indices of the elevators at the given distance, in fleet
+// order; returns how many there are.
+__attribute__((target("avx2"))) size_t ties_avx2(int const *distance,
+                                                 size_t count, int nearest,
+                                                 std::uint32_t *out) {
+  __m256i const wanted = _mm256_set1_epi32(nearest);
+  size_t found = 0;
+
+  for (size_t i = 0; i < count; i += 8) {
+    __m256i const lanes =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(distance + i));
+    auto mask = static_cast<unsigned>(_mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_cmpeq_epi32(lanes, wanted))));
+    while (mask != 0) {
+      out[found++] = static_cast<std::uint32_t>(i + __builtin_ctz(mask));
+      mask &= mask - 1;
+    }
+  }
+  return found;
+}
+
+#endif
+
+}  // namespace
+
+FleetState::Kernel FleetState::best_kernel() noexcept {
+#if defined(__x86_64__)
+  if (__builtin_cpu_supports("avx2")) {
+    return Kernel::Avx2;
+  }
+#endif
+  return Kernel::Scalar;
+}
+
+FleetState::FleetState(std::vector<Elevator> const &elevators, Kernel kernel)
+    : m_kernel(kernel), m_size(elevators.size()) {
+#if !defined(__x86_64__)
+  m_kernel = Kernel::Scalar;
+#endif
+  size_t const padded = (m_size + lanes - 1) / lanes * lanes;
+  m_state.assign(padded, padding_state);
+  m_current_floor.assign(padded, 0);
+  m_target_floor.assign(padded, 0);
+  m_state_time.assign(padded, 0);
+  m_travel_ends.assign(padded, 0);
+  m_max_load.assign(padded, 0);
+  m_approximate.assign(padded, 0);
+  m_distance.assign(padded, unsuitable);
+  m_ties.assign(padded, 0);
+
+  for (size_t i = 0; i < m_size; ++i) {
+    update(i, elevators[i]);
+  }
+}
+
+void FleetState::update(size_t index, Elevator const &elevator) {
+  if (index >= m_size) {
+    throw std::out_of_range("Elevator is not part of the fleet state");
+  }
+  // Floors go through int32 lanes, like the int dispatch casts them to.
+  auto const limit = static_cast<size_t>(std::numeric_limits<int>::max());
+  if (elevator.current_floor() > limit || elevator.target_floor() > limit) {
+    throw std::out_of_range("Elevator floor does not fit the fleet state");
+  }
+
+  m_state[index] = static_cast<std::uint8_t>(elevator.state());
+  m_current_floor[index] = static_cast<std::uint32_t>(elevator.current_floor());
+  m_target_floor[index] = static_cast<std::uint32_t>(elevator.target_floor());
+  m_state_time[index] = elevator.last_state_time();
+  m_travel_ends[index] = elevator.time_travel_ends();
+  m_max_load[index] = elevator.max_load();
+
+  if (m_approximate_valid) {
+    m_approximate[index] = approximate_floor(index, m_approximate_time);
+  }
+}
+
+ElevatorState FleetState::state(size_t index) const noexcept {
+  return static_cast<ElevatorState>(m_state[index]);
+}
+
+int FleetState::approximate_floor(size_t index, size_t time) const noexcept {
+  size_t const current = m_current_floor[index];
+  if (m_state[index] != moving_up && m_state[index] != moving_down) {
+    return static_cast<int>(current);
+  }
+
+  size_t const started = m_state_time[index];
+  size_t const ends = m_travel_ends[index];
+  if (ends == started || time <= started) {
+    return static_cast<int>(current);
+  }
+  if (time >= ends) {
+    return static_cast<int>(m_target_floor[index]);
+  }
+
+  double percentage = static_cast<double>(time - started) /
+                      static_cast<double>(ends - started);
+  double floor_diff = static_cast<double>(m_target_floor[index]) -
+                      static_cast<double>(current);
+  return static_cast<int>(current +
+                          static_cast<size_t>(floor_diff * percentage));
+}
+
+std::span<int const> FleetState::approximate_floors(size_t time) {
+  if (m_approximate_valid && m_approximate_time == time) {
+    return {m_approximate.data(), m_size};
+  }
+
+  switch (m_kernel) {
+#if defined(__x86_64__)
+    case Kernel::Avx2:
+      approximate_floors_avx2(m_state.data(), m_current_floor.data(),
+                              m_target_floor.data(), m_state_time.data(),
+                              m_travel_ends.data(), m_state.size(), time,
+                              m_approximate.data());
+      break;
+#endif
+    default:
+      for (size_t i = 0; i < m_size; ++i) {
+        m_approximate[i] = approximate_floor(i, time);
+      }
+      break;
+  }
+
+  m_approximate_time = time;
+  m_approximate_valid = true;
+  return {m_approximate.data(), m_size};
+}
+
+bool FleetState::preferred(size_t candidate, size_t chosen) const noexcept {
+  return (m_state[candidate] == idle_closed &&
+          m_state[chosen] != idle_closed) ||
+         m_max_load[candidate] > m_max_load[chosen];
+}
+
+bool FleetState::has_suitable(size_t floor, size_t time) {
+  return nearest_suitable(floor, time) != npos;
+}
+
+size_t FleetState::nearest_suitable(size_t floor, size_t time) {
+  approximate_floors(time);
+  auto const f = static_cast<int>(floor);
+
+  int nearest = unsuitable;
+  size_t tied = 0;
+  switch (m_kernel) {
+#if defined(__x86_64__)
+    case Kernel::Avx2:
+      nearest = distances_avx2(m_state.data(), m_approximate.data(),
+                               m_state.size(), f, m_distance.data());
+      if (nearest != unsuitable) {
+        tied = ties_avx2(m_distance.data(), m_state.size(), nearest,
+                         m_ties.data());
+      }
+      break;
+#endif
+    default:
+      for (size_t i = 0; i < m_size; ++i) {
+        m_distance[i] = is_suitable(m_state[i], m_approximate[i], f)
+                            ? std::abs(m_approximate[i] - f)
+                            : unsuitable;
+        nearest = std::min(nearest, m_distance[i]);
+      }
+      for (size_t i = 0; i < m_size && nearest != unsuitable; ++i) {
+        if (m_distance[i] == nearest) {
+          m_ties[tied++] = static_cast<std::uint32_t>(i);
+        }
+      }
+      break;
+  }
+  if (tied == 0) {
+    return npos;
+  }
+
+  // Elevators farther away never survive the scan, so folding the tied ones
+  // in fleet order gives the same answer.
+  size_t chosen = m_ties[0];
+  for (size_t i = 1; i < tied; ++i) {
+    if (preferred(m_ties[i], chosen)) {
+      chosen = m_ties[i];
+    }
+  }
+
+  return chosen;
+}
@@ -0,0 +1,180 @@
+#include "fleet_sweep.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "elevator_file_parser.h"
+#include "work_stealing_pool.h"
+
+namespace {
+
+double mean(size_t total, size_t count) {
+  return count == 0 ? 0.0
+                    : static_cast<double>(total) / static_cast<double>(count);
+}
+
+std::string at_line(size_t line) {
+  return " (line " + std::to_string(line) + ")";
+}
+
+// Order of the groups in FleetSweep::ranked().
+int outcome(SweepResult const &result) {
+  if (!result.error.empty()) {
+    return 2;
+  }
+  return result.stopped_early ? 1 : 0;
+}
+
+}  // namespace
+
+double FleetConfig::total_capacity() const noexcept {
+  return std::accumulate(max_loads.begin(), max_loads.end(), 0.0);
+}
+
+std::vector<FleetConfig> parse_fleet_grid(std::string const &file) {
+  std::ifstream fin(file);
+  if (!fin.is_open()) {
+    throw std::runtime_error("Failed to open fleet grid: " + file);
+  }
+
+  std::vector<FleetConfig> configs;
+  std::string text;
+  for (size_t line = 1; std::getline(fin, text); ++line) {
+    std::istringstream fields(text.substr(0, text.find('#')));
+    FleetConfig config;
+    size_t elevators = 0;
+    if (!(fields >> config.floors_count)) {
+      continue;
+    }
+    if (!(fields >> elevators) || elevators == 0 || config.floors_count < 2) {
+      throw std::runtime_error(
+          "Expected '<floors> <elevators> <max load>...' with at least 2 "
+          "floors and 1 elevator" +
+          at_line(line));
+    }
+
+    double max_load;
+    while (fields >> max_load) {
+      if (max_load <= 0) {
+        throw std::runtime_error("Max load must be positive" + at_line(line));
+      }
+      config.max_loads.push_back(max_load);
+    }
+    if (!fields.eof()) {
+      throw std::runtime_error("Unexpected data in fleet grid" +
+                               at_line(line));
+    }
+    if (config.max_loads.size() == 1) {
+      config.max_loads.resize(elevators, config.max_loads.front());
+    }
+    if (config.max_loads.size() != elevators) {
+      throw std::runtime_error(
+          "Expected 1 or " + std::to_string(elevators) + " max loads, got " +
+          std::to_string(config.max_loads.size()) + at_line(line));
+    }
+    configs.push_back(std::move(config));
+  }
+
+  return configs;
+}
+
+double SweepResult::mean_wait() const noexcept {
+  return mean(totals.total_wait, totals.delivered);
+}
+
+double SweepResult::mean_travel() const noexcept {
+  return mean(totals.total_travel, totals.delivered);
+}
+
+FleetSweep::FleetSweep(std::shared_ptr<PassengerTable const> passengers,
+                       std::vector<FleetConfig> configs)
+    : m_passengers(std::move(passengers)), m_configs(std::move(configs)) {}
+
+FleetSweep &FleetSweep::set_policy(std::string const &name) {
+  m_run_config = visit_builtin_policy(name, []<DispatchPolicy Policy>() {
+    return &FleetSweep::run_config<Policy>;
+  });
+  return *this;
+}
+
+FleetSweep &FleetSweep::set_threads(size_t threads) noexcept {
+  m_threads = threads;
+  return *this;
+}
+
+FleetSweep &FleetSweep::set_mode(SimulationMode mode) noexcept {
+  m_mode = mode;
+  return *this;
+}
+
+FleetSweep &FleetSweep::set_time_limit(size_t limit) noexcept {
+  m_time_limit = limit;
+  return *this;
+}
+
+FleetSweep &FleetSweep::set_wait_target(double mean_wait) noexcept {
+  m_wait_target = mean_wait;
+  return *this;
+}
+
+std::vector<SweepResult> FleetSweep::run() const {
+  std::vector<SweepResult> results(m_configs.size());
+  WorkStealingPool(m_threads).run(m_configs.size(), [&](size_t i) {
+    results[i] = (this->*m_run_config)(m_configs[i]);
+  });
+  return results;
+}
+
+std::vector<SweepResult> FleetSweep::ranked(std::vector<SweepResult> results) {
+  std::stable_sort(
+      results.begin(), results.end(),
+      [](SweepResult const &a, SweepResult const &b) {
+        if (outcome(a) != outcome(b)) {
+          return outcome(a) < outcome(b);
+        }
+        if (outcome(a) != 0) {
+          return false;
+        }
+        if (a.mean_wait() != b.mean_wait()) {
+          return a.mean_wait() < b.mean_wait();
+        }
+        if (a.config.max_loads.size() != b.config.max_loads.size()) {
+          return a.config.max_loads.size() < b.config.max_loads.size();
+        }
+        return a.config.total_capacity() < b.config.total_capacity();
+      });
+  return results;
+}
+
+template <DispatchPolicy Policy>
+SweepResult FleetSweep::run_config(FleetConfig const &config) const {
+  SweepResult result;
+  result.config = config;
+  auto const start = std::chrono::steady_clock::now();
+  try {
+    ElevatorSystem<Policy> system(
+        make_elevators(config.floors_count, config.max_loads),
+        config.floors_count, nullptr);
+    system.set_mode(m_mode).set_time_limit(m_time_limit);
+    if (m_wait_target) {
+      system.set_wait_target(*m_wait_target);
+    }
+    system.model(*m_passengers);
+
+    result.totals = system.passenger_totals();
+    result.end_time = system.time();
+    result.stopped_early = system.stopped_early();
+  } catch (std::exception const &e) {
+    result.error = e.what();
+  }
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+  result.seconds = elapsed.count();
+  return result;
+}
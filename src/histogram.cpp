@@ -0,0 +1,108 @@
+#include "histogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+
+#include "checkpoint.h"
+
+namespace {
+
+static_assert(std::has_single_bit(Histogram::sub_buckets));
+size_t const sub_bits = std::bit_width(Histogram::sub_buckets) - 1;
+
+}  // namespace
+
+// Below 2 * sub_buckets every value has a bucket of its own. Above, the
+// values of one bit width share sub_buckets buckets by their leading bits.
+size_t Histogram::bucket_of(size_t value) noexcept {
+  if (value < 2 * sub_buckets) {
+    return value;
+  }
+  auto const width = static_cast<size_t>(std::bit_width(value));
+  size_t const shift = width - sub_bits - 1;
+  return 2 * sub_buckets + (width - sub_bits - 2) * sub_buckets +
+         ((value >> shift) - sub_buckets);
+}
+
+size_t Histogram::highest_in(size_t bucket) noexcept {
+  if (bucket < 2 * sub_buckets) {
+    return bucket;
+  }
+  size_t const offset = bucket - 2 * sub_buckets;
+  size_t const shift = 1 + offset / sub_buckets;
+  size_t const leading = sub_buckets + offset % sub_buckets;
+  // Wraps to the largest size_t for the very last bucket, as it should.
+  return ((leading + 1) << shift) - 1;
+}
+
+void Histogram::record(size_t value) {
+  size_t const bucket = bucket_of(value);
+  if (bucket >= m_counts.size()) {
+    m_counts.resize(bucket + 1);
+  }
+  ++m_counts[bucket];
+  ++m_count;
+  m_min = std::min(m_min, value);
+  m_max = std::max(m_max, value);
+  m_sum += value;
+}
+
+void Histogram::merge(Histogram const &other) {
+  if (other.m_counts.size() > m_counts.size()) {
+    m_counts.resize(other.m_counts.size());
+  }
+  for (size_t bucket = 0; bucket < other.m_counts.size(); ++bucket) {
+    m_counts[bucket] += other.m_counts[bucket];
+  }
+  m_count += other.m_count;
+  m_min = std::min(m_min, other.m_min);
+  m_max = std::max(m_max, other.m_max);
+  m_sum += other.m_sum;
+}
+
+double Histogram::mean() const noexcept {
+  return m_count == 0 ? 0.0
+                      : static_cast<double>(m_sum) /
+                            static_cast<double>(m_count);
+}
+
+size_t Histogram::percentile(double percent) const noexcept {
+  if (m_count == 0) {
+    return 0;
+  }
+
+  double const wanted =
+      std::ceil(std::clamp(percent, 0.0, 100.0) / 100.0 *
+                static_cast<double>(m_count));
+  size_t const rank =
+      std::clamp<size_t>(static_cast<size_t>(wanted), 1, m_count);
+  size_t seen = 0;
+  for (size_t bucket = 0; bucket < m_counts.size(); ++bucket) {
+    seen += m_counts[bucket];
+    if (seen >= rank) {
+      return std::min(highest_in(bucket), m_max);
+    }
+  }
+  return m_max;
+}
+
+void Histogram::save(CheckpointWriter &out) const {
+  out.put_vector<std::uint64_t>(m_counts);
+  out.put<std::uint64_t>(m_count);
+  out.put<std::uint64_t>(m_min);
+  out.put<std::uint64_t>(m_max);
+  out.put<std::uint64_t>(m_sum);
+}
+
+void Histogram::restore(CheckpointReader &in) {
+  m_counts = in.get_vector<std::uint64_t>();
+  if (m_counts.size() > bucket_of(std::numeric_limits<size_t>::max()) + 1) {
+    throw std::runtime_error("Checkpoint histogram has too many buckets");
+  }
+  m_count = in.get<std::uint64_t>();
+  m_min = in.get<std::uint64_t>();
+  m_max = in.get<std::uint64_t>();
+  m_sum = in.get<std::uint64_t>();
+}
@@ -0,0 +1,134 @@
+#include "log_format.h"
+
+#include <array>
+#include <stdexcept>
+
+namespace {
+
+struct cached_clock_text {
+  time_t second = static_cast<time_t>(-1);
+  char date[11] = {};
+  char time[9] = {};
+};
+
+// Placeholders are expanded once per record, but the clock only changes its
+// text once a second; gmtime/strftime run again only when it does.
+cached_clock_text const &clock_text(time_t current_date_time) {
+  thread_local cached_clock_text cache;
+
+  if (cache.second != current_date_time) {
+    struct tm timeinfo {};
+    if (gmtime_r(&current_date_time, &timeinfo) == nullptr) {
+      throw std::runtime_error("Failed to fetch time");
+    }
+
+    strftime(cache.date, sizeof(cache.date), "%Y-%m-%d", &timeinfo);
+    strftime(cache.time, sizeof(cache.time), "%H:%M:%S", &timeinfo);
+    cache.second = current_date_time;
+  }
+
+  return cache;
+}
+
+} // namespace
+
+log_format::log_format() : log_format("%m") {}
+
+log_format::log_format(std::string const &format) {
+  std::string literal;
+
+  auto flush_literal = [this, &literal]() {
+    if (!literal.empty()) {
+      _literal_length += literal.size();
+      _tokens.push_back({token_kind::literal, std::move(literal)});
+      literal.clear();
+    }
+  };
+
+  for (size_t i = 0; i < format.length(); ++i) {
+    if (format[i] != '%') {
+      literal += format[i];
+      continue;
+    }
+
+    if (i + 1 >= format.length()) {
+      throw std::invalid_argument(
+          "Incomplete placeholder at end of format string");
+    }
+
+    token_kind kind;
+    switch (format[i + 1]) {
+    case 'd':
+      kind = token_kind::date;
+      break;
+    case 't':
+      kind = token_kind::time;
+      break;
+    case 's':
+      kind = token_kind::severity;
+      break;
+    case 'm':
+      kind = token_kind::message;
+      break;
+    default:
+      throw std::invalid_argument("Invalid placeholder %" +
+                                  std::string(1, format[i + 1]));
+    }
+
+    flush_literal();
+    _tokens.push_back({kind, {}});
+    _uses_clock |= kind == token_kind::date || kind == token_kind::time;
+    ++i;
+  }
+
+  flush_literal();
+}
+
+void log_format::render(std::string &buffer, std::string const &message,
+                        logger::severity severity,
+                        time_t current_date_time) const {
+  buffer.clear();
+  buffer.reserve(estimated_length(message));
+
+  cached_clock_text const *clock =
+      _uses_clock ? &clock_text(current_date_time) : nullptr;
+
+  for (auto const &item : _tokens) {
+    switch (item.kind) {
+    case token_kind::literal:
+      buffer += item.literal;
+      break;
+    case token_kind::date:
+      buffer += clock->date;
+      break;
+    case token_kind::time:
+      buffer += clock->time;
+      break;
+    case token_kind::severity:
+      buffer += severity_text(severity);
+      break;
+    case token_kind::message:
+      buffer += message;
+      break;
+    }
+  }
+}
+
+size_t log_format::estimated_length(std::string const &message) const noexcept {
+  return _literal_length + (_tokens.size() * 12) + message.size();
+}
+
+bool log_format::uses_clock() const noexcept { return _uses_clock; }
+
+std::string const &log_format::severity_text(logger::severity severity) {
+  static std::array<std::string, 6> const texts = {
+      logger::severity_to_string(logger::severity::trace),
+      logger::severity_to_string(logger::severity::debug),
+      logger::severity_to_string(logger::severity::information),
+      logger::severity_to_string(logger::severity::warning),
+      logger::severity_to_string(logger::severity::error),
+      logger::severity_to_string(logger::severity::critical),
+  };
+
+  return texts.at(static_cast<size_t>(severity));
+}
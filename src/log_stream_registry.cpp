@@ -0,0 +1,78 @@
+#include "log_stream_registry.h"
+
+#include <functional>
+#include <iostream>
+
+shared_log_stream::shared_log_stream(
+    std::string const &path,
+    std::optional<mapped_log_file::settings> const &mapped_settings) {
+  if (path.empty()) {
+    _stream = &std::cout;
+  } else if (mapped_settings.has_value()) {
+    _mapped_file = std::make_unique<mapped_log_file>(path, *mapped_settings);
+  } else {
+    _file = std::make_unique<std::ofstream>(path);
+    _stream = _file.get();
+  }
+}
+
+shared_log_stream::~shared_log_stream() {
+  if (_stream != nullptr) {
+    _stream->flush();
+  }
+}
+
+void shared_log_stream::write(std::string_view lines, bool flush) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_mapped_file != nullptr) {
+    _mapped_file->write(lines);
+    return;
+  }
+  _stream->write(lines.data(), static_cast<std::streamsize>(lines.size()));
+  if (flush) {
+    _stream->flush();
+  }
+}
+
+void shared_log_stream::flush() {
+  if (_stream == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(_mutex);
+  _stream->flush();
+}
+
+shared_log_stream *log_stream_registry::acquire(
+    std::string const &path,
+    std::optional<mapped_log_file::settings> const &mapped_settings) {
+  shard &owner = shard_of(path);
+  std::lock_guard<std::mutex> lock(owner.mutex);
+
+  auto it = owner.streams.find(path);
+  if (it == owner.streams.end()) {
+    it = owner.streams
+             .emplace(path, std::make_unique<shared_log_stream>(
+                                path, mapped_settings))
+             .first;
+  }
+  ++it->second->_references;
+  return it->second.get();
+}
+
+void log_stream_registry::release(std::string const &path) {
+  shard &owner = shard_of(path);
+  std::lock_guard<std::mutex> lock(owner.mutex);
+
+  auto it = owner.streams.find(path);
+  if (it != owner.streams.end() && --it->second->_references == 0) {
+    owner.streams.erase(it);
+  }
+}
+
+// A function-local table is built on first use, so loggers of other static
+// objects can open streams safely.
+log_stream_registry::shard &
+log_stream_registry::shard_of(std::string const &path) {
+  static std::array<shard, shards_count> shards;
+  return shards[std::hash<std::string>{}(path) % shards_count];
+}
@@ -2,6 +2,10 @@
 
 #include <iomanip>
 
+bool logger::is_enabled(logger::severity /*severity*/) const noexcept {
+  return true;
+}
+
 logger const *logger::trace(std::string const &message) const noexcept {
   return log(message, logger::severity::trace);
 }
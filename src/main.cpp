@@ -1,101 +1,161 @@
 #include <exception>
-#include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
 
 #include "client_logger_builder.h"
 #include "elevator.h"
+#include "elevator_file_parser.h"
 #include "elevator_system.h"
+#include "histogram.h"
 #include "logger.h"
+#include "phase_profiler.h"
+#include "trace_sink.h"
 
-std::pair<std::vector<Elevator>, size_t> parse_elevators_file(
-    std::string const &file) {
-  std::ifstream fin(file);
-  if (!fin.is_open()) {
-    throw std::runtime_error("Failed to open configuration file: " + file);
-  }
-
-  fin.seekg(0, std::ios::end);
-  if (fin.tellg() == 0) {
-    throw std::runtime_error("Configuration file is empty: " + file);
-  }
-  fin.seekg(0, std::ios::beg);
-
-  size_t n_floors = 0;
-  size_t k_elevators = 0;
-
-  if (!(fin >> n_floors >> k_elevators)) {
-    throw std::runtime_error("Failed to read number of floors and elevators");
-  }
-
-  if (n_floors == 0 && n_floors == 1) {
-    throw std::runtime_error("Number of floors (n) must be greater than 1");
-  }
-  if (k_elevators == 0) {
-    throw std::runtime_error("Number of elevators (k) must be positive");
-  }
-
-  std::vector<double> max_loads;
-  max_loads.reserve(k_elevators);
-
-  for (size_t i = 0; i < k_elevators; ++i) {
-    double max_load;
-    if (!(fin >> max_load)) {
-      throw std::runtime_error("Failed to read max_load for elevator " +
-                               std::to_string(i + 1) + ". Expected " +
-                               std::to_string(k_elevators) + " values");
-    }
-
-    if (max_load <= 0) {
-      throw std::runtime_error(
-          "Invalid max_load for elevator " + std::to_string(i + 1) +
-          ": must be positive (got " + std::to_string(max_load) + ")");
-    }
-    max_loads.push_back(max_load);
-  }
-
-  std::string extra_data;
-  if (fin >> extra_data) {
-    throw std::runtime_error(
-        "Unexpected data in configuration file after elevator specifications: "
-        "'" +
-        extra_data + "'");
-  }
-
-  std::vector<Elevator> elevators;
-  elevators.reserve(k_elevators);
-  for (size_t i = 0; i < k_elevators; ++i) {
-    elevators.emplace_back(i + 1, 1, max_loads.at(i), n_floors);
-  }
+namespace {
 
-  return {std::move(elevators), n_floors};
+void print_distribution(std::string const &name, Histogram const &histogram) {
+  std::cout << name << ": " << histogram.count() << " samples, mean "
+            << histogram.mean() << ", p50 " << histogram.percentile(50)
+            << ", p95 " << histogram.percentile(95) << ", p99 "
+            << histogram.percentile(99) << ", max " << histogram.max()
+            << std::endl;
 }
 
+}  // namespace
+
 int main(int argc, char **argv) {
   if (argc < 5) {
     std::cerr << "Not enougth command line arguments.\nUsage: " << argv[0]
               << " <input_elevators_file> <input_passengers_file> "
-                 "<output_passengers_file> <output_elevators_file>"
+                 "<output_passengers_file> <output_elevators_file> [--tick] "
+                 "[--async-log] [--mapped-log] [--stream] [--threads N] "
+                 "[--checkpoints <interval> <file prefix>] "
+                 "[--resume <checkpoint file>] [--stats] "
+                 "[--no-passenger-results] [--profile] [--trace <file>]"
               << std::endl;
     return 1;
   }
 
+  SimulationMode mode = SimulationMode::Event;
+  bool async_log = false;
+  bool mapped_log = false;
+  bool stream = false;
+  size_t threads = 1;
+  size_t checkpoint_interval = 0;
+  std::string checkpoint_prefix;
+  std::string resume_file;
+  bool stats = false;
+  bool passenger_results = true;
+  bool profile = false;
+  std::string trace_file;
+  for (int i = 5; i < argc; ++i) {
+    std::string const option = argv[i];
+    if (option == "--tick") {
+      mode = SimulationMode::Tick;
+    } else if (option == "--async-log") {
+      async_log = true;
+    } else if (option == "--mapped-log") {
+      mapped_log = true;
+    } else if (option == "--stream") {
+      stream = true;
+    } else if (option == "--threads" && i + 1 < argc) {
+      threads = std::stoull(argv[++i]);
+    } else if (option == "--checkpoints" && i + 2 < argc) {
+      checkpoint_interval = std::stoull(argv[++i]);
+      checkpoint_prefix = argv[++i];
+    } else if (option == "--resume" && i + 1 < argc) {
+      resume_file = argv[++i];
+    } else if (option == "--stats") {
+      stats = true;
+    } else if (option == "--no-passenger-results") {
+      passenger_results = false;
+    } else if (option == "--profile") {
+      profile = true;
+    } else if (option == "--trace" && i + 1 < argc) {
+      trace_file = argv[++i];
+    } else {
+      std::cerr << "Unknown option: " << option << std::endl;
+      return 1;
+    }
+  }
+
+  if (profile) {
+    if (!ELEVATOR_PROFILING) {
+      std::cerr << "--profile needs a build with ELEVATOR_PROFILING=ON"
+                << std::endl;
+      return 1;
+    }
+    PhaseProfiler::enable();
+  }
+  // Engine phases are only traced in builds with the phase timers.
+  if (!trace_file.empty() && ELEVATOR_PROFILING) {
+    PhaseProfiler::enable();
+  }
+
   try {
-    std::unique_ptr<logger> log(
-        client_logger_builder()
-            .add_file_stream("files/runtime.log", logger::severity::information)
-            ->add_console_stream(logger::severity::information)
-            ->build());
+    client_logger_builder log_builder;
+    log_builder
+        .add_file_stream("files/runtime.log", logger::severity::information)
+        ->add_console_stream(logger::severity::information);
+    if (async_log) {
+      log_builder.set_async_mode();
+    }
+    if (mapped_log) {
+      log_builder.set_mapped_file_mode();
+    }
+    std::unique_ptr<logger> log(log_builder.build());
     auto [elevators, floors_count] = parse_elevators_file(argv[1]);
     log->information(
         "Parsed elevators file. Results: " + std::to_string(elevators.size()) +
         " elevators, " + std::to_string(floors_count) + " floors");
 
-    ElevatorSystem system(elevators, floors_count, log.get());
-    system.model(argv[2]).print_results(argv[3], argv[4]);
-    std::cout << "Modelation ended. Results written into " << argv[3] << " and "
-              << argv[4] << std::endl;
+    std::unique_ptr<TraceSink> trace;
+    if (!trace_file.empty()) {
+      trace = std::make_unique<TraceSink>(trace_file);
+      PhaseProfiler::set_listener(trace.get());
+    }
+
+    ElevatorSystem<> system(elevators, floors_count, log.get());
+    system.set_mode(mode).set_threads(threads).set_trace(trace.get());
+    if (!passenger_results) {
+      system.stream_without_passenger_results();
+    } else if (stream) {
+      system.stream_passenger_results(argv[3]);
+    }
+    if (checkpoint_interval != 0) {
+      system.set_checkpoints(checkpoint_interval, checkpoint_prefix);
+    }
+    if (resume_file.empty()) {
+      system.model(argv[2]);
+    } else {
+      // The checkpoint holds the passengers; the passengers file is unused.
+      system.restore(resume_file).resume();
+    }
+    system.print_results(argv[3], argv[4]);
+    if (trace) {
+      PhaseProfiler::set_listener(nullptr);
+      trace->close();
+    }
+    if (stats) {
+      print_distribution("Wait time", system.wait_histogram());
+      print_distribution("In-cabin time", system.cabin_histogram());
+      for (size_t i = 0; i < elevators.size(); ++i) {
+        print_distribution(
+            "Elevator " + std::to_string(elevators[i].id()) + " load, %",
+            system.load_histograms()[i]);
+      }
+    }
+    if (passenger_results) {
+      std::cout << "Modelation ended. Results written into " << argv[3]
+                << " and " << argv[4] << std::endl;
+    } else {
+      std::cout << "Modelation ended. Results written into " << argv[4]
+                << std::endl;
+    }
+    if (profile) {
+      PhaseProfiler::report(std::cout);
+    }
     return 0;
   } catch (std::exception const &e) {
     std::cerr << "Runtime error occured during the execution: " << e.what()
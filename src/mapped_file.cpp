@@ -0,0 +1,71 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+MappedFile::MappedFile(std::string const &path) {
+  int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open configuration file: " + path);
+  }
+
+  struct stat info {};
+  if (::fstat(fd, &info) != 0) {
+    ::close(fd);
+    throw std::runtime_error("Failed to read from file: " + path);
+  }
+
+  m_size = static_cast<size_t>(info.st_size);
+  if (m_size > 0) {
+    void *mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      std::string const reason = std::strerror(errno);
+      ::close(fd);
+      throw std::runtime_error("Failed to map file " + path + ": " + reason);
+    }
+    ::madvise(mapping, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<char const *>(mapping);
+  }
+
+  ::close(fd);
+}
+
+MappedFile::~MappedFile() { release(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    release();
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+  }
+  return *this;
+}
+
+void MappedFile::discard_before(size_t offset) noexcept {
+  static size_t const page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+
+  size_t const length = std::min(offset, m_size) / page_size * page_size;
+  if (m_data != nullptr && length > 0) {
+    ::madvise(const_cast<char *>(m_data), length, MADV_DONTNEED);
+  }
+}
+
+void MappedFile::release() noexcept {
+  if (m_data != nullptr) {
+    ::munmap(const_cast<char *>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+  }
+}
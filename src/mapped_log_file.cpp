@@ -0,0 +1,131 @@
+#include "mapped_log_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+mapped_log_file::settings whole_pages(mapped_log_file::settings settings) {
+  static size_t const page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+
+  settings.segment_size =
+      (settings.segment_size + page_size - 1) / page_size * page_size;
+  return settings;
+}
+
+} // namespace
+
+mapped_log_file::mapped_log_file(std::string path,
+                                 settings const &file_settings)
+    : _path(std::move(path)),
+      _settings(whole_pages((validate(file_settings), file_settings))) {
+  if (!open_segment()) {
+    throw std::runtime_error("Failed to create log file " + _path + ": " +
+                             std::strerror(errno));
+  }
+}
+
+mapped_log_file::~mapped_log_file() noexcept { close_segment(); }
+
+void mapped_log_file::validate(settings const &file_settings) {
+  if (file_settings.segment_size == 0) {
+    throw std::invalid_argument("Log segment size must be positive");
+  }
+  if (file_settings.max_segments == 0) {
+    throw std::invalid_argument("Log segment count must be positive");
+  }
+}
+
+void mapped_log_file::write(std::string_view lines) noexcept {
+  while (!lines.empty() && _data != nullptr) {
+    size_t const room = _settings.segment_size - _used;
+    if (lines.size() <= room) {
+      std::memcpy(_data + _used, lines.data(), lines.size());
+      _used += lines.size();
+      return;
+    }
+
+    size_t const last_line_end =
+        room == 0 ? std::string_view::npos : lines.rfind('\n', room - 1);
+    size_t taken = 0;
+    if (last_line_end != std::string_view::npos) {
+      taken = last_line_end + 1;
+    } else if (_used == 0) {
+      taken = room;
+    }
+    std::memcpy(_data + _used, lines.data(), taken);
+    _used += taken;
+    lines.remove_prefix(taken);
+
+    rotate();
+  }
+}
+
+bool mapped_log_file::open_segment() noexcept {
+  _fd = ::open(_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (_fd < 0) {
+    return false;
+  }
+
+  int const error = ::posix_fallocate(_fd, 0, _settings.segment_size);
+  if (error != 0 &&
+      ::ftruncate(_fd, static_cast<off_t>(_settings.segment_size)) != 0) {
+    ::close(_fd);
+    _fd = -1;
+    return false;
+  }
+
+  void *mapping = ::mmap(nullptr, _settings.segment_size,
+                         PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+  if (mapping == MAP_FAILED) {
+    ::close(_fd);
+    _fd = -1;
+    return false;
+  }
+  ::madvise(mapping, _settings.segment_size, MADV_SEQUENTIAL);
+
+  _data = static_cast<char *>(mapping);
+  _used = 0;
+  return true;
+}
+
+void mapped_log_file::close_segment() noexcept {
+  if (_data != nullptr) {
+    ::munmap(_data, _settings.segment_size);
+    _data = nullptr;
+  }
+  if (_fd >= 0) {
+    // Trim the preallocated tail nothing was written to.
+    static_cast<void>(::ftruncate(_fd, static_cast<off_t>(_used)));
+    ::close(_fd);
+    _fd = -1;
+  }
+}
+
+void mapped_log_file::rotate() noexcept {
+  close_segment();
+
+  size_t const kept = _settings.max_segments - 1;
+  if (kept == 0) {
+    std::remove(_path.c_str());
+  } else {
+    std::remove(segment_path(kept).c_str());
+    for (size_t index = kept - 1; index > 0; --index) {
+      std::rename(segment_path(index).c_str(), segment_path(index + 1).c_str());
+    }
+    std::rename(_path.c_str(), segment_path(1).c_str());
+  }
+
+  open_segment();
+}
+
+std::string mapped_log_file::segment_path(size_t index) const {
+  return _path + "." + std::to_string(index);
+}
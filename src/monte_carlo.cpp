@@ -0,0 +1,101 @@
+#include "monte_carlo.h"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include "work_stealing_pool.h"
+
+MonteCarloSummary MonteCarloSummary::of(
+    std::vector<ScenarioResult> const &results) {
+  MonteCarloSummary summary;
+  summary.scenarios = results.size();
+  size_t total_wait = 0;
+  size_t total_travel = 0;
+  size_t total_end_time = 0;
+
+  for (ScenarioResult const &result : results) {
+    if (!result.error.empty()) {
+      ++summary.failed;
+      continue;
+    }
+
+    PassengerTotals const &totals = result.totals;
+    summary.passengers += result.passengers;
+    summary.delivered += totals.delivered;
+    total_wait += totals.total_wait;
+    total_travel += totals.total_travel;
+    total_end_time += result.end_time;
+    summary.max_wait = std::max(summary.max_wait, totals.max_wait);
+    summary.max_travel = std::max(summary.max_travel, totals.max_travel);
+    summary.max_end_time = std::max(summary.max_end_time, result.end_time);
+  }
+
+  if (summary.delivered > 0) {
+    summary.mean_wait = static_cast<double>(total_wait) /
+                        static_cast<double>(summary.delivered);
+    summary.mean_travel = static_cast<double>(total_travel) /
+                          static_cast<double>(summary.delivered);
+  }
+  size_t const finished = summary.scenarios - summary.failed;
+  if (finished > 0) {
+    summary.mean_end_time = static_cast<double>(total_end_time) /
+                            static_cast<double>(finished);
+  }
+  return summary;
+}
+
+MonteCarloRunner::MonteCarloRunner(std::vector<Elevator> elevators,
+                                   size_t floors_count, TrafficProfile profile)
+    : m_elevators(std::move(elevators)),
+      m_floors_count(floors_count),
+      m_traffic(std::move(profile)) {}
+
+MonteCarloRunner &MonteCarloRunner::set_policy(std::string const &name) {
+  m_run_scenario = visit_builtin_policy(name, []<DispatchPolicy Policy>() {
+    return &MonteCarloRunner::run_scenario<Policy>;
+  });
+  return *this;
+}
+
+MonteCarloRunner &MonteCarloRunner::set_threads(size_t threads) noexcept {
+  m_threads = threads;
+  return *this;
+}
+
+MonteCarloRunner &MonteCarloRunner::set_mode(SimulationMode mode) noexcept {
+  m_mode = mode;
+  return *this;
+}
+
+MonteCarloRunner &MonteCarloRunner::set_time_limit(size_t limit) noexcept {
+  m_time_limit = limit;
+  return *this;
+}
+
+std::vector<ScenarioResult> MonteCarloRunner::run(std::uint64_t seed,
+                                                  size_t scenarios) const {
+  std::vector<ScenarioResult> results(scenarios);
+  WorkStealingPool(m_threads).run(scenarios, [&](size_t i) {
+    results[i] = (this->*m_run_scenario)(scenario_seed(seed, i));
+  });
+  return results;
+}
+
+template <DispatchPolicy Policy>
+ScenarioResult MonteCarloRunner::run_scenario(std::uint64_t seed) const {
+  ScenarioResult result;
+  result.seed = seed;
+  try {
+    std::vector<PassengerRecord> const passengers = m_traffic.generate(seed);
+    result.passengers = passengers.size();
+
+    ElevatorSystem<Policy> system(m_elevators, m_floors_count, nullptr);
+    system.set_mode(m_mode).set_time_limit(m_time_limit).model(passengers);
+    result.totals = system.passenger_totals();
+    result.end_time = system.time();
+  } catch (std::exception const &e) {
+    result.error = e.what();
+  }
+  return result;
+}
@@ -0,0 +1,116 @@
+#include "passenger_file_parser.h"
+
+#include <charconv>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+bool is_space(char c) noexcept {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' ||
+         c == '\f';
+}
+
+std::string at_line(size_t line) {
+  return " (line " + std::to_string(line) + ")";
+}
+
+}  // namespace
+
+PassengerFileParser::PassengerFileParser(std::string const &file)
+    : m_file(file) {}
+
+std::string_view PassengerFileParser::next_token() {
+  char const *data = m_file.data();
+  size_t const size = m_file.size();
+
+  while (m_position < size && is_space(data[m_position])) {
+    if (data[m_position] == '\n') {
+      ++m_line;
+    }
+    ++m_position;
+  }
+
+  size_t const begin = m_position;
+  while (m_position < size && !is_space(data[m_position])) {
+    ++m_position;
+  }
+
+  return {data + begin, m_position - begin};
+}
+
+template <typename T>
+T PassengerFileParser::parse_field(std::string_view token, char const *field,
+                                   size_t line) const {
+  T value{};
+  auto [end, error] =
+      std::from_chars(token.data(), token.data() + token.size(), value);
+  if (error != std::errc() || end != token.data() + token.size()) {
+    throw std::runtime_error("Invalid " + std::string(field) + " '" +
+                             std::string(token) + "'" + at_line(line));
+  }
+
+  return value;
+}
+
+bool PassengerFileParser::next(PassengerRecord &record) {
+  std::string_view token = next_token();
+  if (token.empty()) {
+    return false;
+  }
+
+  record.line = m_line;
+  record.id = parse_field<size_t>(token, "passenger id", m_line);
+
+  std::string_view fields[4];
+  for (auto &field : fields) {
+    field = next_token();
+    if (field.empty()) {
+      throw std::runtime_error("Incomplete record for passenger " +
+                               std::to_string(record.id) +
+                               at_line(record.line));
+    }
+  }
+
+  record.weight = parse_field<double>(fields[0], "weight", m_line);
+  record.boarding_floor = parse_field<size_t>(fields[1], "floor", m_line);
+  record.time_text = fields[2];
+  record.appear_time = time_to_numerical(fields[2], m_line);
+  record.target_floor = parse_field<size_t>(fields[3], "floor", m_line);
+
+  return true;
+}
+
+size_t PassengerFileParser::time_to_numerical(std::string_view time,
+                                              size_t line) {
+  size_t const colon_pos = time.find(':');
+  if (colon_pos == std::string_view::npos) {
+    throw std::runtime_error("Invalid time format for '" + std::string(time) +
+                             "'. Expected 'hh:mm'" + at_line(line));
+  }
+
+  std::string_view const hours_str = time.substr(0, colon_pos);
+  std::string_view const minutes_str = time.substr(colon_pos + 1);
+
+  size_t hours = 0;
+  size_t minutes = 0;
+  auto const hours_result = std::from_chars(
+      hours_str.data(), hours_str.data() + hours_str.size(), hours);
+  auto const minutes_result = std::from_chars(
+      minutes_str.data(), minutes_str.data() + minutes_str.size(), minutes);
+  if (hours_result.ec != std::errc() || minutes_result.ec != std::errc() ||
+      hours_result.ptr != hours_str.data() + hours_str.size() ||
+      minutes_result.ptr != minutes_str.data() + minutes_str.size()) {
+    throw std::runtime_error("Invalid time format for '" + std::string(time) +
+                             "'. Expected 'hh:mm'" + at_line(line));
+  }
+
+  if (minutes >= 60) {
+    throw std::runtime_error("Invalid minutes value " +
+                             std::string(minutes_str) + " in '" +
+                             std::string(time) + "'. Must be < 60" +
+                             at_line(line));
+  }
+
+  return (hours * 60) + minutes;
+}
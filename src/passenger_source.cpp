@@ -0,0 +1,49 @@
+#include "passenger_source.h"
+
+#include <stdexcept>
+
+PassengerSource::PassengerSource(std::string const &file) : m_file_name(file) {
+  if (PassengerTrace::is_binary_trace(file)) {
+    m_trace.emplace(file);
+  } else {
+    m_parser.emplace(file);
+  }
+}
+
+bool PassengerSource::next(PassengerRecord &record) {
+  if (m_trace.has_value()) {
+    if (m_position >= m_trace->size()) {
+      return false;
+    }
+
+    record.id = m_trace->ids()[m_position];
+    record.weight = m_trace->weights()[m_position];
+    record.boarding_floor = m_trace->boarding_floors()[m_position];
+    record.appear_time = m_trace->appear_times()[m_position];
+    record.target_floor = m_trace->target_floors()[m_position];
+    record.line = 0;
+    record.time_text = {};
+    ++m_position;
+  } else {
+    if (!m_parser->next(record)) {
+      return false;
+    }
+
+    size_t const consumed = m_parser->bytes_consumed();
+    if (consumed - m_discarded >= discard_step) {
+      m_parser->discard_before(consumed);
+      m_discarded = consumed;
+    }
+  }
+
+  if (record.appear_time < m_last_appear_time) {
+    throw std::runtime_error(
+        "Passengers file is not sorted by appear time: passenger " +
+        std::to_string(record.id) + " in " + m_file_name +
+        (record.line > 0 ? " (line " + std::to_string(record.line) + ")"
+                         : std::string()));
+  }
+  m_last_appear_time = record.appear_time;
+
+  return true;
+}
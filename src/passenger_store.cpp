@@ -0,0 +1,178 @@
+#include "passenger_store.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+Passenger &PassengerStore::hot(size_t slot) const noexcept {
+  return m_hot[slot / chunk_size][slot % chunk_size];
+}
+
+PassengerDetails &PassengerStore::cold(size_t slot) const noexcept {
+  return m_cold[slot / chunk_size][slot % chunk_size];
+}
+
+Passenger *PassengerStore::add(size_t id, size_t appear_time,
+                               size_t boarding_floor, size_t target_floor,
+                               double weight) {
+  if (m_indexing_ids && m_slot_by_id.contains(id)) {
+    return nullptr;
+  }
+
+  size_t slot;
+  if (!m_free_slots.empty()) {
+    slot = m_free_slots.back();
+    m_free_slots.pop_back();
+  } else {
+    if (m_slots == std::numeric_limits<std::uint32_t>::max()) {
+      throw std::length_error("Too many passengers for the passenger store");
+    }
+    if (m_slots == m_hot.size() * chunk_size) {
+      m_hot.push_back(std::make_unique<Passenger[]>(chunk_size));
+      m_cold.push_back(std::make_unique<PassengerDetails[]>(chunk_size));
+    }
+    slot = m_slots++;
+    m_live.push_back(false);
+  }
+
+  auto const slot_number = static_cast<std::uint32_t>(slot);
+  hot(slot) =
+      Passenger(slot_number, appear_time, boarding_floor, target_floor, weight);
+  cold(slot) = PassengerDetails{.id = id};
+  m_live[slot] = true;
+  ++m_size;
+  if (m_indexing_ids) {
+    m_slot_by_id.emplace(id, slot_number);
+  }
+
+  return &hot(slot);
+}
+
+void PassengerStore::remove(Passenger const &passenger) {
+  std::uint32_t const slot = passenger.slot();
+  if (slot >= m_slots || !m_live[slot]) {
+    throw std::out_of_range("Unknown passenger (remove)");
+  }
+
+  if (m_indexing_ids) {
+    m_slot_by_id.erase(cold(slot).id);
+  }
+  m_live[slot] = false;
+  m_free_slots.push_back(slot);
+  --m_size;
+}
+
+Passenger &PassengerStore::at(std::uint32_t slot) {
+  if (slot >= m_slots || !m_live[slot]) {
+    throw std::out_of_range("Unknown passenger slot");
+  }
+
+  return hot(slot);
+}
+
+Passenger const &PassengerStore::at(std::uint32_t slot) const {
+  if (slot >= m_slots || !m_live[slot]) {
+    throw std::out_of_range("Unknown passenger slot");
+  }
+
+  return hot(slot);
+}
+
+PassengerDetails &PassengerStore::details(Passenger const &passenger) {
+  return cold(passenger.slot());
+}
+
+PassengerDetails const &PassengerStore::details(
+    Passenger const &passenger) const {
+  return cold(passenger.slot());
+}
+
+void PassengerStore::sort_by_appear_time(std::uint32_t first) {
+  if (m_size != m_slots) {
+    throw std::logic_error("Passenger store can not be sorted after removals");
+  }
+  if (first >= m_slots) {
+    return;
+  }
+
+  std::vector<std::uint32_t> order(m_slots);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin() + first, order.end(),
+                   [this](std::uint32_t a, std::uint32_t b) {
+                     return hot(a).appear_time() < hot(b).appear_time();
+                   });
+
+  // Applies the permutation cycle by cycle, so no second copy of the
+  // passengers is ever held.
+  std::vector<bool> placed(m_slots);
+  for (size_t start = first; start < m_slots; ++start) {
+    if (placed[start]) {
+      continue;
+    }
+
+    Passenger const hot_carry = hot(start);
+    PassengerDetails const cold_carry = cold(start);
+    size_t slot = start;
+    while (true) {
+      placed[slot] = true;
+      size_t const source = order[slot];
+      if (source == start) {
+        hot(slot) = hot_carry;
+        cold(slot) = cold_carry;
+        break;
+      }
+      hot(slot) = hot(source);
+      cold(slot) = cold(source);
+      slot = source;
+    }
+  }
+
+  for (size_t slot = first; slot < m_slots; ++slot) {
+    Passenger const &passenger = hot(slot);
+    auto const slot_number = static_cast<std::uint32_t>(slot);
+    hot(slot) = Passenger(slot_number, passenger.appear_time(),
+                          passenger.boarding_floor(), passenger.target_floor(),
+                          passenger.weight());
+    if (m_indexing_ids) {
+      m_slot_by_id[cold(slot).id] = slot_number;
+    }
+  }
+}
+
+void PassengerStore::release_id_index() {
+  m_indexing_ids = false;
+  std::unordered_map<size_t, std::uint32_t>().swap(m_slot_by_id);
+}
+
+std::vector<std::uint32_t> PassengerStore::slots_by_id() const {
+  std::vector<std::uint32_t> order;
+  order.reserve(m_size);
+  for (std::uint32_t slot = 0; slot < m_slots; ++slot) {
+    if (m_live[slot]) {
+      order.push_back(slot);
+    }
+  }
+  std::sort(order.begin(), order.end(),
+            [this](std::uint32_t a, std::uint32_t b) {
+              return cold(a).id < cold(b).id;
+            });
+
+  return order;
+}
+
+// Counts the chunks and the bookkeeping containers by capacity; the id index
+// is estimated as one node per entry plus its bucket array.
+size_t PassengerStore::memory_usage() const noexcept {
+  size_t const chunks = m_hot.size() * chunk_size *
+                        (sizeof(Passenger) + sizeof(PassengerDetails));
+  size_t const bookkeeping =
+      m_live.capacity() / 8 + m_free_slots.capacity() * sizeof(std::uint32_t) +
+      m_hot.capacity() * sizeof(m_hot[0]) +
+      m_cold.capacity() * sizeof(m_cold[0]);
+  size_t const id_index =
+      m_slot_by_id.bucket_count() * sizeof(void *) +
+      m_slot_by_id.size() * (sizeof(void *) + sizeof(size_t) * 2);
+
+  return chunks + bookkeeping + id_index;
+}
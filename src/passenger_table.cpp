@@ -0,0 +1,38 @@
+#include "passenger_table.h"
+
+#include <algorithm>
+
+#include "passenger_trace.h"
+
+std::shared_ptr<PassengerTable const> PassengerTable::load(
+    std::string const &file) {
+  auto table = std::make_shared<PassengerTable>();
+  std::vector<PassengerRecord> &records = table->m_records;
+
+  if (PassengerTrace::is_binary_trace(file)) {
+    PassengerTrace const trace(file);
+    records.resize(trace.size());
+    for (size_t i = 0; i < trace.size(); ++i) {
+      records[i] = {.id = trace.ids()[i],
+                    .weight = trace.weights()[i],
+                    .boarding_floor = trace.boarding_floors()[i],
+                    .appear_time = trace.appear_times()[i],
+                    .target_floor = trace.target_floors()[i],
+                    .time_text = {}};
+    }
+  } else {
+    PassengerFileParser parser(file);
+    PassengerRecord record;
+    while (parser.next(record)) {
+      record.time_text = {};  // points into the mapping, which goes away
+      records.push_back(record);
+    }
+  }
+
+  PassengerTrace::sort_and_deduplicate(records);
+  for (PassengerRecord const &record : records) {
+    table->m_top_floor = std::max(
+        {table->m_top_floor, record.boarding_floor, record.target_floor});
+  }
+  return table;
+}
@@ -0,0 +1,141 @@
+#include "passenger_trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace {
+
+constexpr std::uint64_t align_up(std::uint64_t value) {
+  return (value + 7) & ~std::uint64_t{7};
+}
+
+template <typename T, typename Field>
+void write_column(std::ofstream &out, std::vector<PassengerRecord> const &rows,
+                  Field field) {
+  std::vector<T> column;
+  column.reserve(rows.size());
+  for (auto const &row : rows) {
+    column.push_back(static_cast<T>(field(row)));
+  }
+
+  out.write(reinterpret_cast<char const *>(column.data()),
+            static_cast<std::streamsize>(column.size() * sizeof(T)));
+  std::uint64_t const written = column.size() * sizeof(T);
+  static char const padding[8] = {};
+  out.write(padding,
+            static_cast<std::streamsize>(align_up(written) - written));
+}
+
+}  // namespace
+
+PassengerTrace::PassengerTrace(std::string const &file) : m_file(file) {
+  if (m_file.size() < sizeof(Header)) {
+    throw std::runtime_error("Passenger trace is truncated: " + file);
+  }
+
+  Header header{};
+  std::memcpy(&header, m_file.data(), sizeof(Header));
+  if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+    throw std::runtime_error("Not a binary passenger trace: " + file);
+  }
+  if (header.version != version || header.header_size != sizeof(Header)) {
+    throw std::runtime_error("Unsupported passenger trace version " +
+                             std::to_string(header.version) + ": " + file);
+  }
+
+  m_ids = column<std::uint64_t>(header.id_offset, header.count, file);
+  m_weights = column<double>(header.weight_offset, header.count, file);
+  m_boarding_floors = column<std::uint32_t>(header.boarding_floor_offset,
+                                            header.count, file);
+  m_appear_times =
+      column<std::uint64_t>(header.appear_time_offset, header.count, file);
+  m_target_floors =
+      column<std::uint32_t>(header.target_floor_offset, header.count, file);
+}
+
+template <typename T>
+std::span<T const> PassengerTrace::column(std::uint64_t offset,
+                                          std::uint64_t count,
+                                          std::string const &file) const {
+  if (offset % alignof(T) != 0 || offset > m_file.size() ||
+      count > (m_file.size() - offset) / sizeof(T)) {
+    throw std::runtime_error("Passenger trace column out of bounds: " + file);
+  }
+
+  return {reinterpret_cast<T const *>(m_file.data() + offset),
+          static_cast<size_t>(count)};
+}
+
+bool PassengerTrace::is_binary_trace(std::string const &file) {
+  std::ifstream in(file, std::ios::binary);
+  char head[sizeof(magic)] = {};
+  return in.read(head, sizeof(head)) &&
+         std::memcmp(head, magic, sizeof(magic)) == 0;
+}
+
+void PassengerTrace::sort_and_deduplicate(
+    std::vector<PassengerRecord> &records) {
+  std::unordered_set<size_t> seen;
+  std::erase_if(records, [&seen](PassengerRecord const &record) {
+    return !seen.insert(record.id).second;
+  });
+  std::stable_sort(records.begin(), records.end(),
+                   [](PassengerRecord const &a, PassengerRecord const &b) {
+                     return a.appear_time < b.appear_time;
+                   });
+}
+
+void PassengerTrace::write(std::string const &file,
+                           std::vector<PassengerRecord> records) {
+  sort_and_deduplicate(records);
+
+  for (auto const &record : records) {
+    if (record.boarding_floor > std::numeric_limits<std::uint32_t>::max() ||
+        record.target_floor > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::runtime_error("Floor number of passenger " +
+                               std::to_string(record.id) +
+                               " does not fit the trace format");
+    }
+  }
+
+  std::uint64_t const count = records.size();
+  Header header{};
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.header_size = sizeof(Header);
+  header.count = count;
+  header.id_offset = align_up(sizeof(Header));
+  header.weight_offset = align_up(header.id_offset + (count * 8));
+  header.boarding_floor_offset = align_up(header.weight_offset + (count * 8));
+  header.appear_time_offset =
+      align_up(header.boarding_floor_offset + (count * 4));
+  header.target_floor_offset =
+      align_up(header.appear_time_offset + (count * 8));
+
+  std::ofstream out(file, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    throw std::runtime_error("Failed to open output file: " + file);
+  }
+
+  out.write(reinterpret_cast<char const *>(&header), sizeof(header));
+  static char const padding[8] = {};
+  out.write(padding, static_cast<std::streamsize>(header.id_offset -
+                                                  sizeof(header)));
+
+  write_column<std::uint64_t>(out, records, [](auto const &r) { return r.id; });
+  write_column<double>(out, records, [](auto const &r) { return r.weight; });
+  write_column<std::uint32_t>(out, records,
+                              [](auto const &r) { return r.boarding_floor; });
+  write_column<std::uint64_t>(out, records,
+                              [](auto const &r) { return r.appear_time; });
+  write_column<std::uint32_t>(out, records,
+                              [](auto const &r) { return r.target_floor; });
+
+  if (!out) {
+    throw std::runtime_error("Failed to write passenger trace: " + file);
+  }
+}
@@ -0,0 +1,118 @@
+#include "phase_profiler.h"
+
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+using Block = std::array<PhaseProfiler::Counters, PhaseProfiler::phases_count>;
+
+// Blocks outlive their threads, so counts of finished threads still add up.
+std::mutex blocks_mutex;
+std::vector<std::unique_ptr<Block>> blocks;
+
+Block &thread_block() {
+  thread_local Block *block = [] {
+    std::lock_guard<std::mutex> lock(blocks_mutex);
+    return blocks.emplace_back(std::make_unique<Block>()).get();
+  }();
+  return *block;
+}
+
+double per_second(std::uint64_t count, std::uint64_t nanoseconds) {
+  return nanoseconds == 0 ? 0.0
+                          : static_cast<double>(count) * 1e9 /
+                                static_cast<double>(nanoseconds);
+}
+
+}  // namespace
+
+void PhaseProfiler::add(Phase phase, std::uint64_t items,
+                        std::uint64_t nanoseconds) noexcept {
+  Counters &counters = thread_block()[static_cast<size_t>(phase)];
+  ++counters.calls;
+  counters.items += items;
+  counters.nanoseconds += nanoseconds;
+}
+
+std::array<PhaseProfiler::Counters, PhaseProfiler::phases_count>
+PhaseProfiler::totals() {
+  std::array<Counters, phases_count> sums{};
+  std::lock_guard<std::mutex> lock(blocks_mutex);
+  for (auto const &block : blocks) {
+    for (size_t i = 0; i < phases_count; ++i) {
+      sums[i].calls += (*block)[i].calls;
+      sums[i].items += (*block)[i].items;
+      sums[i].nanoseconds += (*block)[i].nanoseconds;
+    }
+  }
+  return sums;
+}
+
+char const *PhaseProfiler::name(Phase phase) noexcept {
+  switch (phase) {
+    case Phase::Load:
+      return "load";
+    case Phase::Model:
+      return "model";
+    case Phase::Tick:
+      return "tick";
+    case Phase::ArrivePassengers:
+      return "arrive passengers";
+    case Phase::Dispatch:
+      return "dispatch";
+    case Phase::FloorArrivals:
+      return "floor arrivals";
+    case Phase::Deboarding:
+      return "deboarding";
+    case Phase::Boarding:
+      return "boarding";
+    case Phase::EventScheduling:
+      return "event scheduling";
+    case Phase::Checkpoint:
+      return "checkpoint";
+    case Phase::Logging:
+      return "logging";
+    case Phase::Results:
+      return "results";
+    case Phase::Count:
+      break;
+  }
+  return "?";
+}
+
+void PhaseProfiler::report(std::ostream &out) {
+  auto const sums = totals();
+  Counters const &model = sums[static_cast<size_t>(Phase::Model)];
+  Counters const &ticks = sums[static_cast<size_t>(Phase::Tick)];
+
+  out << std::left << std::setw(18) << "phase" << std::right << std::setw(12)
+      << "calls" << std::setw(12) << "items" << std::setw(12) << "total ms"
+      << std::setw(10) << "ns/call" << std::setw(10) << "% model" << "\n";
+  for (size_t i = 0; i < phases_count; ++i) {
+    Counters const &phase = sums[i];
+    if (phase.calls == 0) {
+      continue;
+    }
+    out << std::left << std::setw(18) << name(static_cast<Phase>(i))
+        << std::right << std::setw(12) << phase.calls << std::setw(12)
+        << phase.items << std::fixed << std::setprecision(3) << std::setw(12)
+        << static_cast<double>(phase.nanoseconds) / 1e6 << std::setprecision(0)
+        << std::setw(10)
+        << static_cast<double>(phase.nanoseconds) /
+               static_cast<double>(phase.calls)
+        << std::setprecision(1) << std::setw(10)
+        << (model.nanoseconds == 0
+                ? 0.0
+                : 100.0 * static_cast<double>(phase.nanoseconds) /
+                      static_cast<double>(model.nanoseconds))
+        << "\n";
+  }
+  out << std::setprecision(0) << ticks.calls << " ticks, "
+      << per_second(ticks.calls, model.nanoseconds) << " ticks/s; "
+      << model.items << " passengers, "
+      << per_second(model.items, model.nanoseconds) << " passengers/s"
+      << std::defaultfloat << std::setprecision(6) << std::endl;
+}
@@ -0,0 +1,105 @@
+#include "results_writer.h"
+
+#include <stdexcept>
+#include <utility>
+
+ResultsWriter::ResultsWriter(std::string const &file)
+    : m_file(file, std::ios::binary | std::ios::trunc), m_file_name(file) {
+  m_open = m_file.is_open();
+  if (m_open) {
+    m_thread = std::thread(&ResultsWriter::run, this);
+  }
+}
+
+ResultsWriter::~ResultsWriter() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_text.empty()) {
+      m_chunks.push_back(std::move(m_text));
+    }
+    m_stopping = true;
+  }
+  m_changed.notify_all();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+void ResultsWriter::commit() {
+  if (m_text.size() >= chunk_bytes) {
+    queue(std::exchange(m_text, {}));
+  }
+}
+
+void ResultsWriter::write(std::string text) {
+  queue(std::exchange(m_text, {}));
+  queue(std::move(text));
+}
+
+void ResultsWriter::queue(std::string text) {
+  if (!m_open || text.empty()) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_changed.wait(lock, [this] {
+    return m_error || m_chunks.size() < max_pending;
+  });
+  rethrow_error();
+  m_chunks.push_back(std::move(text));
+  lock.unlock();
+  m_changed.notify_all();
+}
+
+void ResultsWriter::close() {
+  if (!m_open) {
+    return;
+  }
+
+  queue(std::exchange(m_text, {}));
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_changed.notify_all();
+  m_thread.join();
+  m_open = false;
+
+  m_file.close();
+  if (!m_file && !m_error) {
+    m_error = std::make_exception_ptr(
+        std::runtime_error("Failed to write results file: " + m_file_name));
+  }
+  rethrow_error();
+}
+
+void ResultsWriter::rethrow_error() {
+  if (m_error) {
+    std::rethrow_exception(std::exchange(m_error, nullptr));
+  }
+}
+
+void ResultsWriter::run() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_changed.wait(lock, [this] { return m_stopping || !m_chunks.empty(); });
+    if (m_chunks.empty()) {
+      return;
+    }
+
+    std::string chunk = std::move(m_chunks.front());
+    m_chunks.pop_front();
+    lock.unlock();
+    m_changed.notify_all();
+
+    bool const written = static_cast<bool>(
+        m_file.write(chunk.data(), static_cast<std::streamsize>(chunk.size())));
+
+    lock.lock();
+    if (!written && !m_error) {
+      m_error = std::make_exception_ptr(
+          std::runtime_error("Failed to write results file: " + m_file_name));
+    }
+    m_changed.notify_all();
+  }
+}
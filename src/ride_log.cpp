@@ -0,0 +1,164 @@
+#include "ride_log.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "checkpoint.h"
+
+namespace {
+
+constexpr std::uint64_t open_sequence =
+    std::numeric_limits<std::uint64_t>::max();
+
+}  // namespace
+
+void RideLog::reserve_elevators(size_t count) {
+  if (count > m_rides_by_elevator.size()) {
+    m_rides_by_elevator.resize(count);
+  }
+}
+
+size_t RideLog::record_boarding(size_t elevator_id, size_t passenger_id,
+                                size_t time, size_t cabin_size) {
+  if (elevator_id >= m_rides_by_elevator.size()) {
+    m_rides_by_elevator.resize(elevator_id + 1);
+  }
+
+  auto &log = m_rides_by_elevator[elevator_id];
+  skip_closed_rides(log);
+
+  size_t const ride = log.first + log.rides.size();
+  log.rides.push_back({passenger_id, time, 0, log.sequence++, open_sequence,
+                       static_cast<std::uint32_t>(cabin_size),
+                       static_cast<std::uint32_t>(ride - log.oldest_open)});
+
+  return ride;
+}
+
+void RideLog::record_deboarding(size_t elevator_id, size_t ride, size_t time) {
+  if (elevator_id >= m_rides_by_elevator.size() ||
+      ride < m_rides_by_elevator[elevator_id].first ||
+      ride - m_rides_by_elevator[elevator_id].first >=
+          m_rides_by_elevator[elevator_id].rides.size()) {
+    throw std::out_of_range("Unknown ride (record_deboarding)");
+  }
+
+  auto &log = m_rides_by_elevator[elevator_id];
+  auto &entry = log.rides[ride - log.first];
+  entry.deboard_time = time;
+  entry.deboard_sequence = log.sequence++;
+}
+
+RideLog::Ride const &RideLog::ride(size_t elevator_id, size_t ride) const {
+  if (elevator_id >= m_rides_by_elevator.size() ||
+      ride < m_rides_by_elevator[elevator_id].first ||
+      ride - m_rides_by_elevator[elevator_id].first >=
+          m_rides_by_elevator[elevator_id].rides.size()) {
+    throw std::out_of_range("Unknown ride");
+  }
+
+  auto const &log = m_rides_by_elevator[elevator_id];
+  return log.rides[ride - log.first];
+}
+
+// Sweeps back from the boarding until every rider that was in the cabin at
+// that moment is found, so the cost is bounded by the rides that started
+// since the oldest co-rider boarded, not by the whole log.
+std::vector<size_t> RideLog::met_passengers(size_t elevator_id,
+                                            size_t ride) const {
+  if (ride == npos) {
+    return {};
+  }
+
+  Ride const &self = this->ride(elevator_id, ride);
+  auto const &log = m_rides_by_elevator[elevator_id];
+
+  std::vector<size_t> met;
+  met.reserve(self.cabin_size);
+  for (size_t i = ride - log.first; i > 0 && met.size() < self.cabin_size;
+       --i) {
+    Ride const &other = log.rides[i - 1];
+    if (other.deboard_sequence > self.board_sequence) {
+      met.push_back(other.passenger_id);
+    }
+  }
+
+  std::sort(met.begin(), met.end());
+  return met;
+}
+
+// The oldest co-rider of a boarding never moves backwards, so everything
+// before the oldest co-rider of the oldest open ride is settled history.
+void RideLog::release_settled(size_t elevator_id) {
+  if (elevator_id >= m_rides_by_elevator.size()) {
+    return;
+  }
+
+  auto &log = m_rides_by_elevator[elevator_id];
+  skip_closed_rides(log);
+
+  size_t const end = log.first + log.rides.size();
+  size_t const oldest_needed =
+      log.oldest_open == end
+          ? end
+          : log.oldest_open - log.rides[log.oldest_open - log.first].cabin_span;
+  log.released = std::max(log.released, oldest_needed);
+
+  // Erase in bulk once the released prefix outweighs the live rides, so
+  // every ride is moved a bounded number of times.
+  size_t const releasable = log.released - log.first;
+  if (releasable > 0 && releasable >= log.rides.size() - releasable) {
+    auto const released_end =
+        log.rides.begin() + static_cast<std::ptrdiff_t>(releasable);
+    log.rides.erase(log.rides.begin(), released_end);
+    log.first = log.released;
+  }
+}
+
+void RideLog::skip_closed_rides(ElevatorRides &log) noexcept {
+  size_t const end = log.first + log.rides.size();
+  while (log.oldest_open < end &&
+         log.rides[log.oldest_open - log.first].deboard_sequence !=
+             open_sequence) {
+    ++log.oldest_open;
+  }
+}
+
+size_t RideLog::rides_count() const noexcept {
+  size_t count = 0;
+  for (auto const &log : m_rides_by_elevator) {
+    count += log.first + log.rides.size();
+  }
+  return count;
+}
+
+// Rides are saved as raw bytes, which must not include padding.
+static_assert(std::has_unique_object_representations_v<RideLog::Ride>);
+
+void RideLog::save(CheckpointWriter &out) const {
+  out.put<std::uint64_t>(m_rides_by_elevator.size());
+  for (auto const &log : m_rides_by_elevator) {
+    out.put_vector<Ride>(log.rides);
+    out.put<std::uint64_t>(log.first);
+    out.put<std::uint64_t>(log.released);
+    out.put<std::uint64_t>(log.oldest_open);
+    out.put(log.sequence);
+  }
+}
+
+void RideLog::restore(CheckpointReader &in) {
+  auto const elevators = in.get<std::uint64_t>();
+  if (elevators > in.remaining()) {
+    throw std::runtime_error("Checkpoint is truncated");
+  }
+  m_rides_by_elevator.resize(elevators);
+  for (auto &log : m_rides_by_elevator) {
+    log.rides = in.get_vector<Ride>();
+    log.first = in.get<std::uint64_t>();
+    log.released = in.get<std::uint64_t>();
+    log.oldest_open = in.get<std::uint64_t>();
+    log.sequence = in.get<std::uint64_t>();
+  }
+}
@@ -0,0 +1,258 @@
+#include "trace_sink.h"
+
+#include <charconv>
+#include <stdexcept>
+
+namespace {
+
+// Trace time is in microseconds; a time unit of the model is shown as one
+// second.
+constexpr size_t micros_per_time_unit = 1000000;
+
+char const *state_name(ElevatorState state) noexcept {
+  switch (state) {
+    case ElevatorState::IdleClosed:
+      return "IdleClosed";
+    case ElevatorState::IdleOpen:
+      return "IdleOpen";
+    case ElevatorState::MovingUp:
+      return "MovingUp";
+    case ElevatorState::MovingDown:
+      return "MovingDown";
+  }
+  return "?";
+}
+
+void append_decimal(std::string &out, double value) {
+  char digits[32];
+  auto const end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+  out.append(digits, end);
+}
+
+void append_model_time(std::string &out, char const *key, size_t time) {
+  out += key;
+  append_number(out, time * micros_per_time_unit);
+}
+
+// Microseconds with the nanoseconds as decimals.
+void append_wall_time(std::string &out, char const *key,
+                      std::chrono::steady_clock::duration time) {
+  auto const nanoseconds =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+  auto const count = static_cast<size_t>(nanoseconds < 0 ? 0 : nanoseconds);
+  out += key;
+  append_number(out, count / 1000);
+  out += '.';
+  size_t const fraction = count % 1000;
+  out += static_cast<char>('0' + fraction / 100);
+  out += static_cast<char>('0' + fraction / 10 % 10);
+  out += static_cast<char>('0' + fraction % 10);
+}
+
+}  // namespace
+
+TraceSink::TraceSink(std::string const &file)
+    : m_writer(file), m_start(std::chrono::steady_clock::now()) {
+  if (!m_writer.is_open()) {
+    throw std::runtime_error("Failed to open trace file: " + file);
+  }
+
+  std::string &out = m_writer.text();
+  out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":";
+  append_number(out, simulation_pid);
+  out += ",\"args\":{\"name\":\"Simulation (1 s per time unit)\"}},\n";
+  out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":";
+  append_number(out, engine_pid);
+  out += ",\"args\":{\"name\":\"Engine (wall clock)\"}}";
+}
+
+TraceSink::~TraceSink() {
+  if (PhaseProfiler::listener() == this) {
+    PhaseProfiler::set_listener(nullptr);
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_closed) {
+    end_trace();
+  }
+}
+
+void TraceSink::add_elevator(Elevator const &elevator) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  begin_event("thread_name", 'M', simulation_pid, elevator.id());
+  std::string &out = m_writer.text();
+  out += ",\"args\":{\"name\":\"Elevator #";
+  append_number(out, elevator.id());
+  out += "\"}";
+  end_event();
+}
+
+// Arrivals where nobody gets on or off leave the state as it was, through
+// states lasting no time, so those are dropped and what they split is
+// joined again.
+void TraceSink::state_changed(Elevator const &elevator, ElevatorState from,
+                              size_t since, ElevatorState /*to*/,
+                              size_t time) {
+  if (time == since) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto const [span, added] = m_open_spans.try_emplace(
+      elevator.id(), StateSpan{from, since, time, elevator.current_floor()});
+  if (added) {
+    return;
+  }
+  if (span->second.state == from && span->second.end == since) {
+    span->second.end = time;
+    return;
+  }
+  write_span(elevator.id(), span->second);
+  span->second = StateSpan{from, since, time, elevator.current_floor()};
+}
+
+void TraceSink::write_span(size_t elevator_id, StateSpan const &span) {
+  begin_event(state_name(span.state), 'X', simulation_pid, elevator_id);
+  std::string &out = m_writer.text();
+  append_model_time(out, ",\"ts\":", span.start);
+  append_model_time(out, ",\"dur\":", span.end - span.start);
+  out += ",\"args\":{\"from floor\":";
+  append_number(out, span.floor);
+  out += '}';
+  end_event();
+}
+
+void TraceSink::passenger_boarded(Elevator const &elevator,
+                                  size_t passenger_id, size_t floor,
+                                  size_t time) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  begin_event("board", 'i', simulation_pid, elevator.id());
+  std::string &out = m_writer.text();
+  append_model_time(out, ",\"ts\":", time);
+  out += ",\"s\":\"t\",\"args\":{\"passenger\":";
+  append_number(out, passenger_id);
+  out += ",\"floor\":";
+  append_number(out, floor);
+  out += '}';
+  end_event();
+}
+
+void TraceSink::passenger_deboarded(Elevator const &elevator,
+                                    size_t passenger_id, size_t floor,
+                                    size_t time) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  begin_event("deboard", 'i', simulation_pid, elevator.id());
+  std::string &out = m_writer.text();
+  append_model_time(out, ",\"ts\":", time);
+  out += ",\"s\":\"t\",\"args\":{\"passenger\":";
+  append_number(out, passenger_id);
+  out += ",\"floor\":";
+  append_number(out, floor);
+  out += '}';
+  end_event();
+}
+
+void TraceSink::cabin_load(Elevator const &elevator, size_t time) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::string const name =
+      "Elevator #" + std::to_string(elevator.id()) + " load";
+  begin_event(name.c_str(), 'C', simulation_pid, 0);
+  std::string &out = m_writer.text();
+  append_model_time(out, ",\"ts\":", time);
+  out += ",\"args\":{\"load\":";
+  append_decimal(out, elevator.current_load());
+  out += '}';
+  end_event();
+}
+
+void TraceSink::floor_queue(size_t floor, size_t waiting, size_t time) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::string const name = "Floor " + std::to_string(floor) + " queue";
+  begin_event(name.c_str(), 'C', simulation_pid, 0);
+  std::string &out = m_writer.text();
+  append_model_time(out, ",\"ts\":", time);
+  out += ",\"args\":{\"waiting\":";
+  append_number(out, waiting);
+  out += '}';
+  end_event();
+}
+
+void TraceSink::phase_ended(Phase phase,
+                            std::chrono::steady_clock::time_point start,
+                            std::chrono::steady_clock::time_point end) {
+  // Per arrival and per message, these would outnumber everything else.
+  if (phase == Phase::Deboarding || phase == Phase::Boarding ||
+      phase == Phase::Logging) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto const [thread, added] =
+      m_threads.try_emplace(std::this_thread::get_id(), m_threads.size() + 1);
+  if (added) {
+    begin_event("thread_name", 'M', engine_pid, thread->second);
+    std::string &out = m_writer.text();
+    out += ",\"args\":{\"name\":\"Thread ";
+    append_number(out, thread->second);
+    out += "\"}";
+    end_event();
+  }
+
+  begin_event(PhaseProfiler::name(phase), 'X', engine_pid, thread->second);
+  std::string &out = m_writer.text();
+  append_wall_time(out, ",\"ts\":", start - m_start);
+  append_wall_time(out, ",\"dur\":", end - start);
+  end_event();
+}
+
+void TraceSink::close() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_closed) {
+      return;
+    }
+    m_closed = true;
+    end_trace();
+  }
+  m_writer.close();
+  if (m_error) {
+    std::rethrow_exception(m_error);
+  }
+}
+
+void TraceSink::end_trace() {
+  for (auto const &[elevator_id, span] : m_open_spans) {
+    write_span(elevator_id, span);
+  }
+  m_open_spans.clear();
+  m_writer.text() += "\n]}\n";
+}
+
+void TraceSink::begin_event(char const *name, char phase, size_t pid,
+                            size_t tid) {
+  std::string &out = m_writer.text();
+  out += ",\n{\"name\":\"";
+  out += name;
+  out += "\",\"ph\":\"";
+  out += phase;
+  out += "\",\"pid\":";
+  append_number(out, pid);
+  out += ",\"tid\":";
+  append_number(out, tid);
+}
+
+void TraceSink::end_event() {
+  m_writer.text() += '}';
+  commit();
+}
+
+// Events come from set_state() and from phase timers being destroyed, so a
+// failed write is kept for close() instead of thrown through them.
+void TraceSink::commit() {
+  if (m_error) {
+    return;
+  }
+  try {
+    m_writer.commit();
+  } catch (...) {
+    m_error = std::current_exception();
+  }
+}
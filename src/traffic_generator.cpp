@@ -0,0 +1,201 @@
+#include "traffic_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numbers>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+class SplitMix64 {
+ public:
+  explicit SplitMix64(std::uint64_t seed) noexcept : m_state(seed) {}
+
+  std::uint64_t next() noexcept {
+    std::uint64_t z = (m_state += 0x9E3779B97F4A7C15);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+  }
+
+  // Uniform in (0, 1]; never 0, so its logarithm is finite.
+  double uniform() noexcept {
+    return static_cast<double>((next() >> 11) + 1) * 0x1p-53;
+  }
+
+ private:
+  std::uint64_t m_state;
+};
+
+size_t const minutes_per_hour = 60;
+int const weight_draws = 64;
+
+std::string at_line(size_t line) {
+  return " (line " + std::to_string(line) + ")";
+}
+
+}  // namespace
+
+TrafficProfile TrafficProfile::uniform(size_t floors_count, double hourly_rate,
+                                       size_t hours) {
+  TrafficProfile profile;
+  profile.hourly_rates.assign(hours, hourly_rate);
+  profile.floors_count = floors_count;
+  profile.trips.assign(floors_count * floors_count, 1);
+  for (size_t floor = 1; floor <= floors_count; ++floor) {
+    profile.trip_weight(floor, floor) = 0;
+  }
+  return profile;
+}
+
+TrafficProfile parse_traffic_profile(std::string const &file,
+                                     size_t floors_count) {
+  std::ifstream fin(file);
+  if (!fin.is_open()) {
+    throw std::runtime_error("Failed to open traffic profile: " + file);
+  }
+
+  TrafficProfile profile = TrafficProfile::uniform(floors_count, 60);
+  std::string text;
+  for (size_t line = 1; std::getline(fin, text); ++line) {
+    std::istringstream fields(text.substr(0, text.find('#')));
+    std::string key;
+    if (!(fields >> key)) {
+      continue;
+    }
+
+    if (key == "rates") {
+      profile.hourly_rates.clear();
+      double rate;
+      while (fields >> rate) {
+        if (rate < 0) {
+          throw std::runtime_error("Hourly rate must not be negative" +
+                                   at_line(line));
+        }
+        profile.hourly_rates.push_back(rate);
+      }
+    } else if (key == "trip") {
+      size_t from = 0;
+      size_t to = 0;
+      double weight = 0;
+      if (!(fields >> from >> to >> weight)) {
+        throw std::runtime_error("Expected 'trip <from> <to> <weight>'" +
+                                 at_line(line));
+      }
+      if (from == 0 || from > floors_count || to == 0 || to > floors_count) {
+        throw std::runtime_error(
+            "Invalid trip " + std::to_string(from) + " -> " +
+            std::to_string(to) + " (building has only " +
+            std::to_string(floors_count) + " floors)" + at_line(line));
+      }
+      if (weight < 0) {
+        throw std::runtime_error("Trip weight must not be negative" +
+                                 at_line(line));
+      }
+      profile.trip_weight(from, to) = weight;
+    } else if (key == "weight") {
+      if (!(fields >> profile.mean_weight >> profile.weight_deviation >>
+            profile.min_weight >> profile.max_weight)) {
+        throw std::runtime_error(
+            "Expected 'weight <mean> <deviation> <min> <max>'" +
+            at_line(line));
+      }
+      if (profile.min_weight <= 0 ||
+          profile.min_weight > profile.max_weight ||
+          profile.weight_deviation < 0) {
+        throw std::runtime_error("Invalid weight distribution" +
+                                 at_line(line));
+      }
+    } else {
+      throw std::runtime_error("Unknown traffic profile setting '" + key +
+                               "'" + at_line(line));
+    }
+
+    fields.clear();
+    std::string extra_data;
+    if (fields >> extra_data) {
+      throw std::runtime_error("Unexpected data '" + extra_data + "'" +
+                               at_line(line));
+    }
+  }
+
+  return profile;
+}
+
+TrafficGenerator::TrafficGenerator(TrafficProfile profile)
+    : m_profile(std::move(profile)) {
+  size_t const floors = m_profile.floors_count;
+  if (m_profile.trips.size() != floors * floors) {
+    throw std::runtime_error("Trip matrix does not match the floors count");
+  }
+
+  m_cumulative_trips.reserve(m_profile.trips.size());
+  double total = 0;
+  for (size_t i = 0; i < m_profile.trips.size(); ++i) {
+    if (i / floors != i % floors) {
+      total += m_profile.trips[i];
+    }
+    m_cumulative_trips.push_back(total);
+  }
+  if (total <= 0) {
+    throw std::runtime_error("Traffic profile has no trips between floors");
+  }
+}
+
+std::vector<PassengerRecord> TrafficGenerator::generate(
+    std::uint64_t seed) const {
+  SplitMix64 random(seed);
+  size_t const floors = m_profile.floors_count;
+  double const total_trips = m_cumulative_trips.back();
+  std::vector<PassengerRecord> passengers;
+
+  auto const draw_weight = [&] {
+    double weight = m_profile.mean_weight;
+    for (int i = 0; i < weight_draws; ++i) {
+      double const radius = std::sqrt(-2 * std::log(random.uniform()));
+      weight = m_profile.mean_weight +
+               m_profile.weight_deviation * radius *
+                   std::cos(2 * std::numbers::pi * random.uniform());
+      if (weight >= m_profile.min_weight && weight <= m_profile.max_weight) {
+        return weight;
+      }
+    }
+    return std::clamp(weight, m_profile.min_weight, m_profile.max_weight);
+  };
+
+  // Arrivals are a Poisson process whose rate is constant within an hour;
+  // it has no memory, so every hour can start its own gaps.
+  for (size_t hour = 0; hour < m_profile.hourly_rates.size(); ++hour) {
+    double const rate =
+        m_profile.hourly_rates[hour] / static_cast<double>(minutes_per_hour);
+    if (rate <= 0) {
+      continue;
+    }
+
+    double const end = static_cast<double>((hour + 1) * minutes_per_hour);
+    double time = static_cast<double>(hour * minutes_per_hour);
+    while ((time -= std::log(random.uniform()) / rate) < end) {
+      size_t const trip = static_cast<size_t>(
+          std::upper_bound(m_cumulative_trips.begin(),
+                           m_cumulative_trips.end(),
+                           random.uniform() * total_trips * (1 - 0x1p-53)) -
+          m_cumulative_trips.begin());
+
+      PassengerRecord &record = passengers.emplace_back();
+      record.id = passengers.size();
+      record.appear_time = static_cast<size_t>(time);
+      record.boarding_floor = trip / floors + 1;
+      record.target_floor = trip % floors + 1;
+      record.weight = draw_weight();
+    }
+  }
+
+  return passengers;
+}
+
+std::uint64_t scenario_seed(std::uint64_t base_seed, size_t index) noexcept {
+  return SplitMix64(base_seed + index).next();
+}
@@ -0,0 +1,226 @@
+#include "what_if.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+#include "elevator_file_parser.h"
+
+namespace {
+
+// Earliest of two times a step was reached at, skipping a side that never
+// got there.
+size_t earliest_reached(size_t a, bool a_reached, size_t b, bool b_reached) {
+  if (a_reached && b_reached) {
+    return std::min(a, b);
+  }
+  return a_reached ? a : b;
+}
+
+}  // namespace
+
+WhatIf::WhatIf(size_t floors_count, std::vector<double> max_loads,
+               std::shared_ptr<PassengerTable const> passengers)
+    : m_floors_count(floors_count),
+      m_max_loads(std::move(max_loads)),
+      m_passengers(std::move(passengers)) {}
+
+WhatIf &WhatIf::set_policy(std::string const &name) {
+  m_model = visit_builtin_policy(name, []<DispatchPolicy Policy>() {
+    return &WhatIf::model<Policy>;
+  });
+  m_checkpoints.clear();
+  m_baseline.reset();
+  return *this;
+}
+
+WhatIf &WhatIf::set_mode(SimulationMode mode) noexcept {
+  m_mode = mode;
+  m_checkpoints.clear();
+  m_baseline.reset();
+  return *this;
+}
+
+WhatIf &WhatIf::set_time_limit(size_t limit) noexcept {
+  m_time_limit = limit;
+  m_checkpoints.clear();
+  m_baseline.reset();
+  return *this;
+}
+
+WhatIf &WhatIf::set_checkpoint_interval(size_t interval) {
+  if (interval == 0) {
+    throw std::invalid_argument("Checkpoint interval must be positive");
+  }
+  m_checkpoint_interval = interval;
+  m_checkpoints.clear();
+  m_baseline.reset();
+  return *this;
+}
+
+WhatIfResult const &WhatIf::run_baseline() {
+  m_checkpoints.clear();
+  m_baseline.reset();
+  m_baseline = (this->*m_model)(m_max_loads, {}, nullptr, &m_checkpoints);
+  return *m_baseline;
+}
+
+WhatIfResult WhatIf::run(WhatIfScenario const &scenario,
+                         bool from_scratch) const {
+  if (!m_baseline) {
+    throw std::runtime_error("What-if scenarios need a baseline run first");
+  }
+
+  size_t const earliest = earliest_effect(scenario);
+  std::vector<double> max_loads = m_max_loads;
+  for (auto const &[id, max_load] : scenario.max_loads) {
+    max_loads[id - 1] = max_load;
+  }
+
+  Checkpoint const *from = nullptr;
+  if (!from_scratch) {
+    for (Checkpoint const &checkpoint : m_checkpoints) {
+      if (checkpoint.time > earliest) {
+        break;
+      }
+      from = &checkpoint;
+    }
+  }
+
+  WhatIfResult result =
+      (this->*m_model)(max_loads, scenario.added_passengers, from, nullptr);
+  result.earliest_effect = earliest;
+  if (from != nullptr) {
+    result.resumed_from = from->time;
+  }
+  compare_with_baseline(result);
+  return result;
+}
+
+size_t WhatIf::earliest_effect(WhatIfScenario const &scenario) const {
+  size_t earliest = std::numeric_limits<size_t>::max();
+  for (PassengerRecord const &record : scenario.added_passengers) {
+    earliest = std::min(earliest, record.appear_time);
+  }
+
+  std::vector<double> max_loads = m_max_loads;
+  for (auto const &[id, max_load] : scenario.max_loads) {
+    if (id == 0 || id > max_loads.size()) {
+      throw std::runtime_error("Unknown elevator #" + std::to_string(id));
+    }
+    if (max_load <= 0) {
+      throw std::runtime_error("Max load must be positive");
+    }
+    max_loads[id - 1] = max_load;
+  }
+
+  for (size_t i = 0; i < max_loads.size(); ++i) {
+    if (max_loads[i] == m_max_loads[i]) {
+      continue;
+    }
+
+    // Dispatch breaks ties by max load, so a car passing another one in
+    // that order may be picked differently from the very start.
+    double const low = std::min(max_loads[i], m_max_loads[i]);
+    double const high = std::max(max_loads[i], m_max_loads[i]);
+    for (size_t j = 0; j < max_loads.size(); ++j) {
+      if (j == i) {
+        continue;
+      }
+      for (double load : {m_max_loads[j], max_loads[j]}) {
+        if (low <= load && load <= high) {
+          return 0;
+        }
+      }
+    }
+
+    // An empty car moves the same whatever its max load, so nothing changes
+    // before the first boarding or overload.
+    size_t unused_until = 0;
+    for (Checkpoint const &checkpoint : m_checkpoints) {
+      if (checkpoint.used[i]) {
+        break;
+      }
+      unused_until = checkpoint.time;
+    }
+    earliest = std::min(earliest, unused_until);
+  }
+  return earliest;
+}
+
+void WhatIf::compare_with_baseline(WhatIfResult &result) const {
+  auto after = result.passengers.begin();
+  for (PassengerResult const &before : m_baseline->passengers) {
+    while (after != result.passengers.end() && after->id < before.id) {
+      ++after;
+    }
+    if (after == result.passengers.end() || after->id != before.id) {
+      continue;
+    }
+
+    size_t time;
+    if (before.board_time != after->board_time ||
+        before.elevator_id != after->elevator_id ||
+        before.had_overload != after->had_overload) {
+      time = earliest_reached(before.board_time, before.elevator_id != 0,
+                              after->board_time, after->elevator_id != 0);
+    } else if (before.deboard_time != after->deboard_time) {
+      time = earliest_reached(before.deboard_time, before.deboard_time != 0,
+                              after->deboard_time, after->deboard_time != 0);
+    } else {
+      continue;
+    }
+
+    ++result.diverged_passengers;
+    result.first_divergence = std::min(
+        result.first_divergence.value_or(std::numeric_limits<size_t>::max()),
+        time);
+  }
+}
+
+template <DispatchPolicy Policy>
+WhatIfResult WhatIf::model(std::vector<double> const &max_loads,
+                           std::span<PassengerRecord const> added,
+                           Checkpoint const *from,
+                           std::vector<Checkpoint> *checkpoints) const {
+  WhatIfResult result;
+  auto const start = std::chrono::steady_clock::now();
+
+  ElevatorSystem<Policy> system(make_elevators(m_floors_count, max_loads),
+                                m_floors_count, nullptr);
+  system.set_mode(m_mode).set_time_limit(m_time_limit);
+  if (checkpoints != nullptr) {
+    system.set_checkpoints(
+        m_checkpoint_interval, [&](size_t time, std::vector<char> image) {
+          Checkpoint &checkpoint = checkpoints->emplace_back();
+          checkpoint.time = time;
+          checkpoint.image = std::move(image);
+          for (Elevator const &e : system.elevators()) {
+            checkpoint.used.push_back(e.total_cargo() > 0 ||
+                                      e.overloads_count() > 0);
+          }
+        });
+  }
+
+  if (from != nullptr) {
+    system.restore(std::span<char const>(from->image))
+        .add_passengers(added)
+        .resume();
+  } else if (added.empty()) {
+    system.model(*m_passengers);
+  } else {
+    std::vector<PassengerRecord> records(m_passengers->records().begin(),
+                                         m_passengers->records().end());
+    records.insert(records.end(), added.begin(), added.end());
+    system.model(records);
+  }
+
+  result.passengers = system.passenger_results();
+  result.totals = system.passenger_totals();
+  result.end_time = system.time();
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+  result.seconds = elapsed.count();
+  return result;
+}
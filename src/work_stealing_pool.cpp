@@ -0,0 +1,134 @@
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <new>
+
+// The indices a thread has left, [begin, end). The owner takes from begin,
+// thieves from end.
+struct alignas(std::hardware_destructive_interference_size)
+    WorkStealingPool::Share {
+  std::mutex mutex;
+  size_t begin = 0;
+  size_t end = 0;
+
+  bool take_front(size_t &index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (begin == end) {
+      return false;
+    }
+    index = begin++;
+    return true;
+  }
+
+  bool take_back(size_t &index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (begin == end) {
+      return false;
+    }
+    index = --end;
+    return true;
+  }
+};
+
+WorkStealingPool::WorkStealingPool(size_t threads)
+    : m_threads(threads != 0
+                    ? threads
+                    : std::max<size_t>(std::thread::hardware_concurrency(),
+                                       1)),
+      m_shares(std::make_unique<Share[]>(m_threads)) {
+  m_workers.reserve(m_threads - 1);
+  for (size_t i = 1; i < m_threads; ++i) {
+    m_workers.emplace_back(&WorkStealingPool::serve, this, i);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_start.notify_all();
+  for (auto &worker : m_workers) {
+    worker.join();
+  }
+}
+
+void WorkStealingPool::run(size_t count,
+                           std::function<void(size_t)> const &task) {
+  if (m_threads == 1 || count <= 1) {
+    for (size_t i = 0; i < count; ++i) {
+      task(i);
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < m_threads; ++i) {
+    m_shares[i].begin = count * i / m_threads;
+    m_shares[i].end = count * (i + 1) / m_threads;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_task = &task;
+    m_busy = m_workers.size();
+    ++m_generation;
+  }
+  m_start.notify_all();
+  drain(0);
+
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_busy == 0; });
+    m_task = nullptr;
+    std::swap(error, m_error);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void WorkStealingPool::serve(size_t self) {
+  size_t seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_start.wait(lock,
+                   [&] { return m_stopping || m_generation != seen; });
+      if (m_stopping) {
+        return;
+      }
+      seen = m_generation;
+    }
+
+    drain(self);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (--m_busy == 0) {
+      m_done.notify_one();
+    }
+  }
+}
+
+void WorkStealingPool::drain(size_t self) {
+  size_t index;
+  while (true) {
+    bool found = m_shares[self].take_front(index);
+    for (size_t step = 1; !found && step < m_threads; ++step) {
+      found = m_shares[(self + step) % m_threads].take_back(index);
+    }
+    // Shares only shrink during a run, so once all are empty they stay so.
+    if (!found) {
+      return;
+    }
+
+    try {
+      (*m_task)(index);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_error) {
+        m_error = std::current_exception();
+      }
+    }
+  }
+}
@@ -0,0 +1,77 @@
+// FleetState kernels against Elevator::elevator_aproximate_floor: the
+// approximate floor of every elevator and the nearest suitable one for a
+// call, over random fleets at random times. The scalar kernel and the best
+// one for this CPU have to agree with Elevator, and each other, bit for bit.
+// Fleet sizes are chosen to leave padding lanes in the last vector.
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "elevator.h"
+#include "fleet_state.h"
+
+namespace {
+
+size_t const floors = 500;
+size_t const times = 500;
+
+std::vector<Elevator> random_fleet(size_t elevators, std::mt19937_64 &random) {
+  double const loads[] = {90, 130, 260, 500};
+  std::vector<Elevator> fleet;
+  fleet.reserve(elevators);
+  for (size_t i = 0; i < elevators; ++i) {
+    Elevator &elevator = fleet.emplace_back(
+        i + 1, static_cast<int>(1 + random() % floors), loads[random() % 4],
+        floors);
+    size_t const started = random() % 20000;
+    elevator.set_target_floor(1 + random() % floors);
+    elevator.set_state(static_cast<ElevatorState>(random() % 4), started);
+    elevator.calculate_moving_time(started);
+  }
+  return fleet;
+}
+
+size_t mismatches(size_t elevators) {
+  std::mt19937_64 random(elevators);
+  std::vector<Elevator> const fleet = random_fleet(elevators, random);
+  FleetState scalar(fleet, FleetState::Kernel::Scalar);
+  FleetState best(fleet);
+
+  size_t found = 0;
+  for (size_t t = 0; t < times; ++t) {
+    size_t const time = random() % 40000;
+    auto const expected = scalar.approximate_floors(time);
+    auto const actual = best.approximate_floors(time);
+    for (size_t i = 0; i < elevators; ++i) {
+      int const reference =
+          static_cast<int>(fleet[i].elevator_aproximate_floor(time));
+      found += expected[i] != reference || actual[i] != reference;
+    }
+    size_t const floor = 1 + random() % floors;
+    found += scalar.nearest_suitable(floor, time) !=
+             best.nearest_suitable(floor, time);
+  }
+
+  if (found != 0) {
+    std::cerr << elevators << " elevators: " << found << " mismatches"
+              << std::endl;
+  }
+  return found;
+}
+
+}  // namespace
+
+int main() {
+  std::cout << "best kernel: "
+            << (FleetState::best_kernel() == FleetState::Kernel::Avx2
+                    ? "AVX2"
+                    : "scalar")
+            << std::endl;
+
+  size_t found = 0;
+  for (size_t elevators : {1, 5, 67, 1000}) {
+    found += mismatches(elevators);
+  }
+  return found == 0 ? 0 : 1;
+}
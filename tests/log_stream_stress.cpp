@@ -0,0 +1,144 @@
+// Many threads logging to a few shared files at once, one of them mapped,
+// each through loggers of its own, sync and async, while other loggers on
+// the same files are built, copied and dropped. Every line has to come out
+// whole, once, and in order per thread, or the stress fails. Meant for a
+// build with -DELEVATOR_TSAN=ON as well.
+//
+// Usage: log_stream_stress [threads] [lines per thread]
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client_logger.h"
+#include "client_logger_builder.h"
+#include "logger.h"
+
+namespace {
+
+size_t const files_count = 3;
+size_t const churn_every = 500;
+
+std::string file_name(size_t file) {
+  return (std::filesystem::temp_directory_path() /
+          ("log_stream_stress_" + std::to_string(file) + ".log"))
+      .string();
+}
+
+std::unique_ptr<logger> make_logger(size_t file, bool async) {
+  client_logger_builder builder;
+  builder.set_log_format("%m");
+  builder.add_file_stream(file_name(file), logger::severity::information);
+  if (async) {
+    builder.set_async_mode();
+  }
+  if (file == files_count - 1) {
+    builder.set_mapped_file_mode();
+  }
+  return std::unique_ptr<logger>(builder.build());
+}
+
+// Lines vary in length so that torn writes show.
+void log_lines(size_t thread, size_t lines) {
+  std::unique_ptr<logger> log = make_logger(thread % files_count, thread % 2);
+  for (size_t i = 0; i < lines; ++i) {
+    log->information("thread " + std::to_string(thread) + " line " +
+                     std::to_string(i) + " " + std::string(i % 61, 'x') +
+                     " end");
+    if (i % churn_every == 0) {
+      std::unique_ptr<logger> other =
+          make_logger((thread + 1) % files_count, thread % 3 == 0);
+      client_logger const copy(dynamic_cast<client_logger const &>(*other));
+      other.reset();
+      copy.information("thread " + std::to_string(thread) + " extra " +
+                         std::to_string(i / churn_every) + " end");
+    }
+  }
+}
+
+// Counts the lines of each thread in one file, failing on any line that is
+// not whole or comes out of order.
+bool check_file(size_t file, size_t threads, std::vector<size_t> &lines,
+                std::vector<size_t> &extras) {
+  std::ifstream in(file_name(file));
+  std::string line;
+  while (std::getline(in, line)) {
+    size_t thread = 0;
+    size_t number = 0;
+    char kind[8] = {};
+    bool const parsed = std::sscanf(line.c_str(), "thread %zu %7s %zu",
+                                    &thread, kind, &number) == 3;
+    std::string const kind_text = kind;
+    if (!parsed || thread >= threads || !line.ends_with(" end") ||
+        (kind_text != "line" && kind_text != "extra")) {
+      std::cerr << file_name(file) << ": torn line: " << line << std::endl;
+      return false;
+    }
+
+    std::vector<size_t> &counts = kind_text == "line" ? lines : extras;
+    if (number != counts[thread]) {
+      std::cerr << file_name(file) << ": thread " << thread << " " << kind
+                << " " << number << " where " << counts[thread]
+                << " was due" << std::endl;
+      return false;
+    }
+    ++counts[thread];
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t const threads = argc > 1 ? std::stoull(argv[1]) : 8;
+  size_t const lines = argc > 2 ? std::stoull(argv[2]) : 20000;
+
+  auto const start = std::chrono::steady_clock::now();
+  {
+    // Keep every file open throughout, as reopening truncates it.
+    std::vector<std::unique_ptr<logger>> anchors;
+    for (size_t file = 0; file < files_count; ++file) {
+      anchors.push_back(make_logger(file, false));
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t thread = 0; thread < threads; ++thread) {
+      workers.emplace_back(log_lines, thread, lines);
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::vector<size_t> lines_seen(threads);
+  std::vector<size_t> extras_seen(threads);
+  bool ok = true;
+  for (size_t file = 0; file < files_count && ok; ++file) {
+    ok = check_file(file, threads, lines_seen, extras_seen);
+  }
+  for (size_t thread = 0; thread < threads && ok; ++thread) {
+    size_t const extras = (lines + churn_every - 1) / churn_every;
+    if (lines_seen[thread] != lines || extras_seen[thread] != extras) {
+      std::cerr << "thread " << thread << ": " << lines_seen[thread]
+                << " lines and " << extras_seen[thread] << " extras of "
+                << lines << " and " << extras << std::endl;
+      ok = false;
+    }
+  }
+
+  for (size_t file = 0; file < files_count; ++file) {
+    std::filesystem::remove(file_name(file));
+  }
+  std::cout << threads << " threads x " << lines << " lines into "
+            << files_count << " files: " << (ok ? "ok" : "FAILED") << ", "
+            << elapsed.count() << " s" << std::endl;
+  return ok ? 0 : 1;
+}
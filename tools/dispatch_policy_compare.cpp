@@ -0,0 +1,88 @@
+// Runs every built-in dispatch policy over the same elevators and passengers
+// files and prints their wall time and passenger wait/travel statistics side
+// by side. Nothing is logged and no results files are written. A policy that
+// has not delivered everyone by the time limit is reported as failed.
+
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "dispatch_policy.h"
+#include "elevator_file_parser.h"
+#include "elevator_system.h"
+
+namespace {
+
+double mean(size_t total, size_t count) {
+  return count == 0 ? 0.0
+                    : static_cast<double>(total) / static_cast<double>(count);
+}
+
+size_t const default_time_limit = 1000000;
+
+template <DispatchPolicy Policy>
+void run(std::string const &elevators_file, std::string const &passengers_file,
+         SimulationMode mode, size_t time_limit) {
+  std::cout << std::left << std::setw(18) << Policy::name << std::right;
+  try {
+    auto [elevators, floors_count] = parse_elevators_file(elevators_file);
+    ElevatorSystem<Policy> system(std::move(elevators), floors_count, nullptr);
+    system.set_mode(mode).set_time_limit(time_limit);
+
+    auto const start = std::chrono::steady_clock::now();
+    system.model(passengers_file);
+    std::chrono::duration<double> const elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    PassengerTotals const &totals = system.passenger_totals();
+    std::cout << std::fixed << std::setprecision(3) << std::setw(10)
+              << elapsed.count() << std::setw(11) << totals.delivered
+              << std::setprecision(1) << std::setw(11)
+              << mean(totals.total_wait, totals.delivered) << std::setw(10)
+              << totals.max_wait << std::setw(13)
+              << mean(totals.total_travel, totals.delivered) << std::setw(12)
+              << totals.max_travel << std::endl;
+  } catch (std::exception const &e) {
+    std::cout << "  failed: " << e.what() << std::endl;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <input_elevators_file> <input_passengers_file> [--tick] "
+                 "[--time-limit <time>]"
+              << std::endl;
+    return 1;
+  }
+
+  SimulationMode mode = SimulationMode::Event;
+  size_t time_limit = default_time_limit;
+  for (int i = 3; i < argc; ++i) {
+    std::string const option = argv[i];
+    if (option == "--tick") {
+      mode = SimulationMode::Tick;
+    } else if (option == "--time-limit" && i + 1 < argc) {
+      time_limit = std::stoull(argv[++i]);
+    } else {
+      std::cerr << "Unknown option: " << option << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << std::left << std::setw(18) << "policy" << std::right
+            << std::setw(10) << "wall s" << std::setw(11) << "delivered"
+            << std::setw(11) << "mean wait" << std::setw(10) << "max wait"
+            << std::setw(13) << "mean travel" << std::setw(12) << "max travel"
+            << std::endl;
+
+  run<NearestSuitableDispatch>(argv[1], argv[2], mode, time_limit);
+  run<IdleFirstDispatch>(argv[1], argv[2], mode, time_limit);
+  run<EtaDispatch>(argv[1], argv[2], mode, time_limit);
+  run<ZonedDispatch>(argv[1], argv[2], mode, time_limit);
+  return 0;
+}
@@ -0,0 +1,108 @@
+// Models one passengers file against every fleet of a grid file and prints
+// the configurations ranked by mean wait. The passengers file is parsed
+// once and shared by all runs, which go to a work-stealing thread pool.
+// With --wait-target, runs stop as soon as their mean wait is sure to
+// exceed it and rank below the finished ones.
+
+#include <algorithm>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include "fleet_sweep.h"
+#include "passenger_table.h"
+
+namespace {
+
+size_t const default_time_limit = 1000000;
+
+std::string describe_loads(std::vector<double> const &max_loads) {
+  std::ostringstream out;
+  if (std::equal(max_loads.begin() + 1, max_loads.end(), max_loads.begin())) {
+    out << max_loads.size() << 'x' << max_loads.front();
+    return out.str();
+  }
+
+  for (size_t i = 0; i < max_loads.size(); ++i) {
+    out << (i == 0 ? "" : ",") << max_loads[i];
+  }
+  return out.str();
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <input_passengers_file> <fleet_grid_file> "
+                 "[--wait-target <mean wait>] [--threads <threads>] "
+                 "[--policy <name>] [--tick] [--time-limit <time>]"
+              << std::endl;
+    return 1;
+  }
+
+  std::optional<double> wait_target;
+  size_t threads = 0;
+  std::string policy = NearestSuitableDispatch::name;
+  SimulationMode mode = SimulationMode::Event;
+  size_t time_limit = default_time_limit;
+  for (int i = 3; i < argc; ++i) {
+    std::string const option = argv[i];
+    if (option == "--tick") {
+      mode = SimulationMode::Tick;
+    } else if (option == "--wait-target" && i + 1 < argc) {
+      wait_target = std::stod(argv[++i]);
+    } else if (option == "--threads" && i + 1 < argc) {
+      threads = std::stoull(argv[++i]);
+    } else if (option == "--policy" && i + 1 < argc) {
+      policy = argv[++i];
+    } else if (option == "--time-limit" && i + 1 < argc) {
+      time_limit = std::stoull(argv[++i]);
+    } else {
+      std::cerr << "Unknown option: " << option << std::endl;
+      return 1;
+    }
+  }
+
+  try {
+    auto const passengers = PassengerTable::load(argv[1]);
+    FleetSweep sweep(passengers, parse_fleet_grid(argv[2]));
+    sweep.set_policy(policy).set_threads(threads).set_mode(mode);
+    sweep.set_time_limit(time_limit);
+    if (wait_target) {
+      sweep.set_wait_target(*wait_target);
+    }
+    std::vector<SweepResult> const results = FleetSweep::ranked(sweep.run());
+
+    std::cout << passengers->size() << " passengers, " << results.size()
+              << " configurations\n"
+              << std::right << std::setw(4) << "rank" << std::setw(8)
+              << "floors" << "  " << std::left << std::setw(24) << "max loads"
+              << std::right << std::setw(11) << "mean wait" << std::setw(10)
+              << "max wait" << std::setw(13) << "mean travel" << std::setw(10)
+              << "wall s" << "  result" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+      SweepResult const &result = results[i];
+      std::cout << std::setw(4) << i + 1 << std::setw(8)
+                << result.config.floors_count << "  " << std::left
+                << std::setw(24) << describe_loads(result.config.max_loads)
+                << std::right << std::fixed << std::setprecision(1)
+                << std::setw(11) << result.mean_wait() << std::setw(10)
+                << result.totals.max_wait << std::setw(13)
+                << result.mean_travel() << std::setprecision(3)
+                << std::setw(10) << result.seconds << "  "
+                << (!result.error.empty() ? "failed: " + result.error
+                    : result.stopped_early ? "stopped early"
+                                           : "finished")
+                << std::endl;
+    }
+    return 0;
+  } catch (std::exception const &e) {
+    std::cerr << "Runtime error occured during the execution: " << e.what()
+              << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,142 @@
+// Models many randomized days of one building in a single process: every
+// scenario draws its passengers from a traffic profile with its own seed,
+// and the scenarios run on a thread pool. Prints the aggregate statistics,
+// and one line per scenario into a file if asked to. The output only
+// depends on the seed, never on the thread count.
+//
+// The default policy is eta: on random traffic the original dispatcher
+// sends elevators past the top floor and leaves some calls unserved.
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "dispatch_policy.h"
+#include "elevator_file_parser.h"
+#include "monte_carlo.h"
+#include "traffic_generator.h"
+
+namespace {
+
+size_t const default_time_limit = 1000000;
+double const default_hourly_rate = 60;
+
+double mean(size_t total, size_t count) {
+  return count == 0 ? 0.0
+                    : static_cast<double>(total) / static_cast<double>(count);
+}
+
+void write_scenarios(std::string const &file,
+                     std::vector<ScenarioResult> const &results) {
+  std::ofstream out(file);
+  if (!out.is_open()) {
+    throw std::runtime_error("Failed to open scenarios file: " + file);
+  }
+
+  out << "seed passengers delivered mean_wait max_wait mean_travel "
+         "max_travel end_time error\n"
+      << std::fixed << std::setprecision(3);
+  for (ScenarioResult const &result : results) {
+    PassengerTotals const &totals = result.totals;
+    out << result.seed << ' ' << result.passengers << ' ' << totals.delivered
+        << ' ' << mean(totals.total_wait, totals.delivered) << ' '
+        << totals.max_wait << ' '
+        << mean(totals.total_travel, totals.delivered) << ' '
+        << totals.max_travel << ' ' << result.end_time << ' '
+        << (result.error.empty() ? "-" : result.error) << '\n';
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <input_elevators_file> <scenarios> [--seed <seed>] "
+                 "[--threads <threads>] [--traffic <profile_file>] "
+                 "[--policy <name>] [--tick] "
+                 "[--time-limit <time>] [--scenarios-out <file>]"
+              << std::endl;
+    return 1;
+  }
+
+  std::uint64_t seed = 1;
+  size_t threads = 0;
+  std::string profile_file;
+  std::string scenarios_file;
+  std::string policy = EtaDispatch::name;
+  SimulationMode mode = SimulationMode::Event;
+  size_t time_limit = default_time_limit;
+  for (int i = 3; i < argc; ++i) {
+    std::string const option = argv[i];
+    if (option == "--tick") {
+      mode = SimulationMode::Tick;
+    } else if (option == "--seed" && i + 1 < argc) {
+      seed = std::stoull(argv[++i]);
+    } else if (option == "--threads" && i + 1 < argc) {
+      threads = std::stoull(argv[++i]);
+    } else if (option == "--traffic" && i + 1 < argc) {
+      profile_file = argv[++i];
+    } else if (option == "--policy" && i + 1 < argc) {
+      policy = argv[++i];
+    } else if (option == "--time-limit" && i + 1 < argc) {
+      time_limit = std::stoull(argv[++i]);
+    } else if (option == "--scenarios-out" && i + 1 < argc) {
+      scenarios_file = argv[++i];
+    } else {
+      std::cerr << "Unknown option: " << option << std::endl;
+      return 1;
+    }
+  }
+
+  try {
+    size_t const scenarios = std::stoull(argv[2]);
+    auto [elevators, floors_count] = parse_elevators_file(argv[1]);
+
+    TrafficProfile profile;
+    if (profile_file.empty()) {
+      // Without a profile nobody is too heavy for any of the elevators.
+      profile = TrafficProfile::uniform(floors_count, default_hourly_rate);
+      for (Elevator const &elevator : elevators) {
+        profile.max_weight = std::min(profile.max_weight, elevator.max_load());
+      }
+      profile.min_weight = std::min(profile.min_weight, profile.max_weight);
+    } else {
+      profile = parse_traffic_profile(profile_file, floors_count);
+    }
+
+    MonteCarloRunner runner(std::move(elevators), floors_count,
+                            std::move(profile));
+    runner.set_policy(policy)
+        .set_threads(threads)
+        .set_mode(mode)
+        .set_time_limit(time_limit);
+    std::vector<ScenarioResult> const results = runner.run(seed, scenarios);
+    MonteCarloSummary const summary = MonteCarloSummary::of(results);
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "Scenarios: " << summary.scenarios << " (" << summary.failed
+              << " failed)\n"
+              << "Passengers: " << summary.passengers << ", delivered "
+              << summary.delivered << "\n"
+              << "Wait: mean " << summary.mean_wait << ", max "
+              << summary.max_wait << "\n"
+              << "Travel: mean " << summary.mean_travel << ", max "
+              << summary.max_travel << "\n"
+              << "Day ends: mean " << summary.mean_end_time << ", max "
+              << summary.max_end_time << std::endl;
+
+    if (!scenarios_file.empty()) {
+      write_scenarios(scenarios_file, results);
+    }
+    return summary.failed == 0 ? 0 : 2;
+  } catch (std::exception const &e) {
+    std::cerr << "Runtime error occured during the execution: " << e.what()
+              << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,36 @@
+// Converts a text passengers file into the binary trace format read by
+// ElevatorSystem::model (see passenger_trace.h).
+
+#include <exception>
+#include <iostream>
+#include <vector>
+
+#include "passenger_file_parser.h"
+#include "passenger_trace.h"
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <input_passengers_file> <output_trace_file>" << std::endl;
+    return 1;
+  }
+
+  try {
+    PassengerFileParser parser(argv[1]);
+    std::vector<PassengerRecord> records;
+    PassengerRecord record;
+    while (parser.next(record)) {
+      record.time_text = {};
+      records.push_back(record);
+    }
+
+    size_t const parsed = records.size();
+    PassengerTrace::write(argv[2], std::move(records));
+    std::cout << "Converted " << parsed << " records from " << argv[1]
+              << " into " << argv[2] << std::endl;
+    return 0;
+  } catch (std::exception const &e) {
+    std::cerr << "Conversion failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,131 @@
+// Models a passengers file once as a baseline, then again with some max
+// loads changed or passengers added, resuming from the last in-memory
+// checkpoint before the change can matter. Prints where the scenario first
+// departs from the baseline and what it costs to find out. With --verify,
+// the scenario is also modeled from scratch and has to come out the same.
+
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include "elevator_file_parser.h"
+#include "passenger_table.h"
+#include "what_if.h"
+
+namespace {
+
+size_t const default_time_limit = 1000000;
+
+double mean(size_t total, size_t count) {
+  return count == 0 ? 0.0
+                    : static_cast<double>(total) / static_cast<double>(count);
+}
+
+std::string describe(std::optional<size_t> time) {
+  return time ? std::to_string(*time) : "-";
+}
+
+void print_result(std::string const &name, WhatIfResult const &result) {
+  std::cout << std::left << std::setw(10) << name << std::right
+            << std::setw(10) << result.totals.delivered << std::fixed
+            << std::setprecision(1) << std::setw(11)
+            << mean(result.totals.total_wait, result.totals.delivered)
+            << std::setw(13)
+            << mean(result.totals.total_travel, result.totals.delivered)
+            << std::setw(9) << result.end_time << std::setprecision(3)
+            << std::setw(10) << result.seconds << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <input_elevators_file> <input_passengers_file> "
+                 "[--max-load <elevator id> <max load>]... "
+                 "[--add-passengers <passengers file>] [--policy <name>] "
+                 "[--tick] [--checkpoint-interval <time>] "
+                 "[--time-limit <time>] [--verify]"
+              << std::endl;
+    return 1;
+  }
+
+  WhatIfScenario scenario;
+  std::optional<std::string> added_file;
+  std::string policy = NearestSuitableDispatch::name;
+  SimulationMode mode = SimulationMode::Event;
+  size_t checkpoint_interval = WhatIf::default_checkpoint_interval;
+  size_t time_limit = default_time_limit;
+  bool verify = false;
+  for (int i = 3; i < argc; ++i) {
+    std::string const option = argv[i];
+    if (option == "--tick") {
+      mode = SimulationMode::Tick;
+    } else if (option == "--verify") {
+      verify = true;
+    } else if (option == "--max-load" && i + 2 < argc) {
+      size_t const id = std::stoull(argv[++i]);
+      scenario.max_loads.emplace_back(id, std::stod(argv[++i]));
+    } else if (option == "--add-passengers" && i + 1 < argc) {
+      added_file = argv[++i];
+    } else if (option == "--policy" && i + 1 < argc) {
+      policy = argv[++i];
+    } else if (option == "--checkpoint-interval" && i + 1 < argc) {
+      checkpoint_interval = std::stoull(argv[++i]);
+    } else if (option == "--time-limit" && i + 1 < argc) {
+      time_limit = std::stoull(argv[++i]);
+    } else {
+      std::cerr << "Unknown option: " << option << std::endl;
+      return 1;
+    }
+  }
+
+  try {
+    auto const [elevators, floors_count] = parse_elevators_file(argv[1]);
+    std::vector<double> max_loads;
+    for (Elevator const &e : elevators) {
+      max_loads.push_back(e.max_load());
+    }
+    if (added_file) {
+      auto const added = PassengerTable::load(*added_file);
+      scenario.added_passengers.assign(added->records().begin(),
+                                       added->records().end());
+    }
+
+    WhatIf what_if(floors_count, max_loads, PassengerTable::load(argv[2]));
+    what_if.set_policy(policy).set_mode(mode).set_time_limit(time_limit);
+    what_if.set_checkpoint_interval(checkpoint_interval);
+
+    std::cout << std::left << std::setw(10) << "run" << std::right
+              << std::setw(10) << "delivered" << std::setw(11) << "mean wait"
+              << std::setw(13) << "mean travel" << std::setw(9) << "end"
+              << std::setw(10) << "wall s" << std::endl;
+    print_result("baseline", what_if.run_baseline());
+    WhatIfResult const result = what_if.run(scenario);
+    print_result("what-if", result);
+
+    std::cout << what_if.checkpoints_count() << " checkpoints, earliest "
+              << "effect at " << result.earliest_effect << ", resumed from "
+              << describe(result.resumed_from) << "\n"
+              << result.diverged_passengers
+              << " passengers of the trace diverged, first at "
+              << describe(result.first_divergence) << std::endl;
+
+    if (verify) {
+      WhatIfResult const scratch = what_if.run(scenario, true);
+      print_result("scratch", scratch);
+      bool const same = scratch.passengers == result.passengers &&
+                        scratch.end_time == result.end_time;
+      std::cout << (same ? "same as from scratch" : "MISMATCH with scratch")
+                << std::endl;
+      return same ? 0 : 1;
+    }
+    return 0;
+  } catch (std::exception const &e) {
+    std::cerr << "Runtime error occured during the execution: " << e.what()
+              << std::endl;
+    return 1;
+  }
+}